@@ -2,6 +2,15 @@
 #define _YOLOX_CPP_CORE_HPP
 
 #include <opencv2/core/types.hpp>
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+#include <chrono>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "simd.hpp"
 
 namespace yolox_cpp
 {
@@ -17,15 +26,286 @@ namespace yolox_cpp
         float prob;
     };
 
-    struct GridAndStride
+    // Decode constants of every anchor, in output order, as separate arrays so the
+    // box decode can load them into vectors. x / y: grid cell origin in input pixels.
+    struct AnchorTable
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> stride;
+        size_t size() const
+        {
+            return this->stride.size();
+        }
+    };
+
+    // Detections as one array per field, for callers that copy them into their own layout.
+    // rect: x, y, width, height in frame pixels.
+    struct ObjectArrays
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> width;
+        std::vector<float> height;
+        std::vector<float> prob;
+        std::vector<int> label;
+        size_t size() const
+        {
+            return this->prob.size();
+        }
+    };
+
+    // Input normalization, decided by model_version
+    enum class NormalizeMode
+    {
+        NONE,     // raw 0-255 BGR
+        MEAN_STD, // (img / 255.0 - mean) / std, model_version 0.1.0
+    };
+
+    // Pixel layout of an input frame. Anything but BGR is converted to BGR
+    // inside the letterbox pass, row by row, without a full-frame intermediate.
+    enum class PixelFormat
+    {
+        BGR,  // CV_8UC3
+        RGB,  // CV_8UC3
+        YUYV, // CV_8UC2, Y0 U Y1 V (yuv422_yuy2)
+        UYVY, // CV_8UC2, U Y0 V Y1 (yuv422)
+        NV12, // CV_8UC1, image height * 3 / 2 rows: the Y plane, then the interleaved UV plane (as for cv::COLOR_YUV2BGR_NV12)
+    };
+
+    // Width and height of the image held by frame
+    inline cv::Size image_size(const cv::Mat &frame, const PixelFormat format)
+    {
+        if (format == PixelFormat::NV12)
+        {
+            return cv::Size(frame.cols, frame.rows * 2 / 3);
+        }
+        return frame.size();
+    }
+
+    // Converts source row y of img to packed BGR (img.cols pixels), BT.601 limited range
+    // in fixed point with the coefficients of cv::cvtColor.
+    inline void convert_row_to_bgr(const cv::Mat &img, const PixelFormat format, const int y, uint8_t *dst)
+    {
+        const int width = img.cols;
+        const uint8_t *src = img.ptr<uint8_t>(y);
+        if (format == PixelFormat::BGR)
+        {
+            std::copy(src, src + width * 3, dst);
+            return;
+        }
+        if (format == PixelFormat::RGB)
+        {
+            for (int x = 0; x < width; ++x)
+            {
+                dst[x * 3 + 0] = src[x * 3 + 2];
+                dst[x * 3 + 1] = src[x * 3 + 1];
+                dst[x * 3 + 2] = src[x * 3 + 0];
+            }
+            return;
+        }
+
+        constexpr int shift = 20;
+        constexpr int cy = 1220542;
+        constexpr int cub = 2116026;
+        constexpr int cug = -409993;
+        constexpr int cvg = -852492;
+        constexpr int cvr = 1673527;
+        auto saturate = [](const int v) -> uint8_t
+        {
+            return static_cast<uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+        };
+        auto yuv_to_bgr = [&](const int luma, const int u, const int v, uint8_t *out)
+        {
+            const int yy = std::max(0, luma - 16) * cy;
+            out[0] = saturate((yy + (1 << (shift - 1)) + cub * u) >> shift);
+            out[1] = saturate((yy + (1 << (shift - 1)) + cvg * v + cug * u) >> shift);
+            out[2] = saturate((yy + (1 << (shift - 1)) + cvr * v) >> shift);
+        };
+
+        if (format == PixelFormat::NV12)
+        {
+            const uint8_t *uv = img.ptr<uint8_t>(img.rows * 2 / 3 + y / 2);
+            for (int x = 0; x < width; ++x)
+            {
+                const int c = x & ~1;
+                yuv_to_bgr(src[x], uv[c] - 128, uv[c + 1] - 128, dst + x * 3);
+            }
+            return;
+        }
+
+        // packed 4:2:2, two pixels per 4 bytes
+        const int y_ofs = (format == PixelFormat::YUYV) ? 0 : 1;
+        const int u_ofs = (format == PixelFormat::YUYV) ? 1 : 0;
+        const int v_ofs = u_ofs + 2;
+        for (int x = 0; x < width; ++x)
+        {
+            const uint8_t *pair = src + (x & ~1) * 2;
+            yuv_to_bgr(pair[(x & 1) * 2 + y_ofs], pair[u_ofs] - 128, pair[v_ofs] - 128, dst + x * 3);
+        }
+    }
+
+    // NMS implementation
+    enum class NmsMethod
+    {
+        REFERENCE, // pairwise cv::Rect_ intersection against every picked box
+        SOA,       // picked boxes kept as corner arrays, IoU tested with SIMD
+        GRID,      // picked boxes bucketed on a coarse grid, only nearby ones tested
+    };
+
+    inline NmsMethod nms_method_from_name(const std::string &name)
+    {
+        if (name == "reference")
+        {
+            return NmsMethod::REFERENCE;
+        }
+        if (name == "soa")
+        {
+            return NmsMethod::SOA;
+        }
+        if (name == "grid")
+        {
+            return NmsMethod::GRID;
+        }
+        throw std::invalid_argument("unknown nms method: " + name);
+    }
+
+    // Layout of the model output
+    enum class OutputFormat
+    {
+        RAW,     // anchors x (5 + classes), boxes relative to the grid (decoded here)
+        DECODED, // anchors x (5 + classes), boxes already cx, cy, w, h in input pixels
+        NMS,     // N x 7 detections after in-graph NMS: batch, class, score, x0, y0, x1, y1 in input pixels
+    };
+
+    inline OutputFormat output_format_from_name(const std::string &name)
+    {
+        if (name == "raw")
+        {
+            return OutputFormat::RAW;
+        }
+        if (name == "decoded")
+        {
+            return OutputFormat::DECODED;
+        }
+        if (name == "nms")
+        {
+            return OutputFormat::NMS;
+        }
+        throw std::invalid_argument("unknown output format: " + name);
+    }
+
+    // Scratch buffers of the SOA / GRID NMS engines
+    struct NmsScratch
+    {
+        std::vector<float> x0;
+        std::vector<float> y0;
+        std::vector<float> x1;
+        std::vector<float> y1;
+        std::vector<float> area;
+        std::vector<std::vector<int>> cells;
+        std::vector<int> visited;
+    };
+
+    // Per-class buckets for class-aware NMS. Indexed by label, each bucket keeps the
+    // proposals of one class in score order and its own NMS scratch.
+    struct ClassBuckets
+    {
+        std::vector<std::vector<Object>> objects;
+        std::vector<std::vector<int>> index;
+        std::vector<std::vector<int>> picked;
+        std::vector<NmsScratch> scratch;
+        std::vector<int> active;
+    };
+
+    // Working memory of decode_outputs, kept between calls so that a steady stream of
+    // frames does not allocate. One instance per concurrent decode.
+    struct DecodeScratch
+    {
+        // anchors surviving the objectness pre-filter
+        std::vector<int> candidate_anchors;
+        // decoded boxes of the proposals, x0 / y0 / w / h planes
+        std::vector<float> boxes;
+        std::vector<Object> proposals;
+        std::vector<int> picked;
+        // quantized outputs: the candidate rows, dequantized, and their anchors
+        std::vector<float> dequant_rows;
+        AnchorTable dequant_anchors;
+        NmsScratch nms;
+        ClassBuckets class_buckets;
+        // stage times of the last decode, microseconds (profiling only)
+        double decode_us = 0.0;
+        double nms_us = 0.0;
+    };
+
+    // Affine quantization of a uint8 / int8 tensor: real = (q - zero_point) * scale
+    struct Quantization
+    {
+        float scale = 1.0f;
+        int zero_point = 0;
+    };
+
+    // IEEE half precision element of an fp16 tensor
+    struct Float16
+    {
+        uint16_t bits;
+    };
+    static_assert(sizeof(Float16) == sizeof(uint16_t), "Float16 must map fp16 tensor memory");
+
+    // Elements of a non-float output tensor -> float.
+    // uint8 / int8 are dequantized with quant, fp16 ignores it.
+    template <typename T>
+    inline float to_f32(const T v, const Quantization &quant)
     {
-        int grid0;
-        int grid1;
-        int stride;
-        GridAndStride(const int grid0_, const int grid1_, const int stride_)
-            : grid0(grid0_), grid1(grid1_), stride(stride_)
+        return (static_cast<int>(v) - quant.zero_point) * quant.scale;
+    }
+
+    inline float to_f32(const Float16 v, const Quantization &)
+    {
+        return simd::half_to_f32(v.bits);
+    }
+
+    template <typename T>
+    inline void to_f32(const T *src, const size_t n, const Quantization &quant, float *dst)
+    {
+        for (size_t i = 0; i < n; ++i)
         {
+            dst[i] = to_f32(src[i], quant);
         }
+    }
+
+    inline void to_f32(const Float16 *src, const size_t n, const Quantization &, float *dst)
+    {
+        simd::half_to_f32(reinterpret_cast<const uint16_t *>(src), dst, n);
+    }
+
+    // Wall time per stage of the last inference call, microseconds.
+    // Batched calls report the sum over their frames.
+    struct StageTimes
+    {
+        double preprocess = 0.0;
+        double infer = 0.0;
+        double decode = 0.0;
+        double nms = 0.0;
+    };
+
+    // Bilinear sampling table for letterbox resize of a given source size.
+    // x offsets are byte offsets into a BGR row, y offsets are row indices,
+    // alpha is the weight of the second tap.
+    struct LetterboxTable
+    {
+        int src_w = -1;
+        int src_h = -1;
+        int dst_w = -1;
+        int dst_h = -1;
+        int unpad_w = 0;
+        int unpad_h = 0;
+        std::vector<int> x_ofs0;
+        std::vector<int> x_ofs1;
+        std::vector<float> x_alpha;
+        std::vector<int> y_ofs0;
+        std::vector<int> y_ofs1;
+        std::vector<float> y_alpha;
     };
 
     class AbcYoloX
@@ -38,10 +318,204 @@ namespace yolox_cpp
             : nms_thresh_(nms_th), bbox_conf_thresh_(conf_th),
               num_classes_(num_classes), p6_(p6), model_version_(model_version)
         {
+            set_normalize_mode(model_version == "0.1.0" ? NormalizeMode::MEAN_STD : NormalizeMode::NONE);
+        }
+        // Detections of one frame are written to objects, whose capacity is reused
+        // by callers that pass the same vector for every frame. Frames that are not
+        // BGR are converted inside the letterbox, see PixelFormat.
+        virtual void inference(const cv::Mat &frame, const PixelFormat format, std::vector<Object> &objects) = 0;
+
+        void inference(const cv::Mat &frame, std::vector<Object> &objects)
+        {
+            this->inference(frame, PixelFormat::BGR, objects);
+        }
+
+        std::vector<Object> inference(const cv::Mat &frame, const PixelFormat format = PixelFormat::BGR)
+        {
+            std::vector<Object> objects;
+            this->inference(frame, format, objects);
+            return objects;
+        }
+
+        // Same, as one array per field
+        void inference(const cv::Mat &frame, const PixelFormat format, ObjectArrays &arrays)
+        {
+            this->inference(frame, format, this->result_scratch_);
+            to_arrays(this->result_scratch_, arrays);
+        }
+
+        void inference(const cv::Mat &frame, ObjectArrays &arrays)
+        {
+            this->inference(frame, PixelFormat::BGR, arrays);
+        }
+
+        // Runs several frames of the same format at once. Backends whose model accepts a
+        // dynamic batch override this with a single N x 3 x H x W call, the default runs
+        // frames one by one.
+        virtual std::vector<std::vector<Object>> inference_batch(const std::vector<cv::Mat> &frames, const PixelFormat format)
+        {
+            std::vector<std::vector<Object>> results(frames.size());
+            for (size_t i = 0; i < frames.size(); ++i)
+            {
+                this->inference(frames[i], format, results[i]);
+            }
+            return results;
+        }
+
+        std::vector<std::vector<Object>> inference_batch(const std::vector<cv::Mat> &frames)
+        {
+            return this->inference_batch(frames, PixelFormat::BGR);
+        }
+
+        // For models exported with dynamic H / W: the input size is picked per frame to match
+        // the frame's aspect ratio within max_w x max_h (e.g. 640x384 for 16:9 instead of
+        // 640x640), so no compute is spent on padding rows. Anchor tables and backend buffers
+        // are cached per size. 0 x 0 restores the fixed input size.
+        void set_dynamic_input(const int max_w, const int max_h)
+        {
+            const bool enable = max_w > 0 && max_h > 0;
+            if (enable && !this->supports_dynamic_input())
+            {
+                throw std::runtime_error("the model input size is fixed");
+            }
+            if (enable && !this->dynamic_input())
+            {
+                this->fixed_input_size_ = cv::Size(this->input_w_, this->input_h_);
+            }
+            else if (!enable && this->dynamic_input())
+            {
+                use_input_size(this->fixed_input_size_);
+            }
+            this->dynamic_max_w_ = enable ? max_w : 0;
+            this->dynamic_max_h_ = enable ? max_h : 0;
+        }
+
+        // true if the model accepts any H / W (multiples of the largest stride)
+        virtual bool supports_dynamic_input() const
+        {
+            return false;
+        }
+
+        bool dynamic_input() const
+        {
+            return this->dynamic_max_w_ > 0;
+        }
+
+        // Tiled inference for frames much larger than the model input. The frame is cut into
+        // overlapping tile_w x tile_h crops (frame pixels, 0: model input size), optionally plus
+        // the whole frame as a global view. All of them run as one inference_batch() and their
+        // detections are merged with one more NMS. Objects larger than the overlap are only
+        // found whole by the global view.
+        void set_tiling(const int tile_w, const int tile_h, const float overlap, const bool global_view)
+        {
+            this->tile_w_ = tile_w;
+            this->tile_h_ = tile_h;
+            this->tile_overlap_ = std::min(std::max(overlap, 0.0f), 0.9f);
+            this->tile_global_view_ = global_view;
+        }
+
+        void inference_tiled(const cv::Mat &frame, std::vector<Object> &objects)
+        {
+            this->inference_tiled(frame, PixelFormat::BGR, objects);
+        }
+
+        void inference_tiled(const cv::Mat &frame, const PixelFormat format, std::vector<Object> &objects)
+        {
+            const cv::Mat *src = &frame;
+            PixelFormat src_format = format;
+            if (format == PixelFormat::NV12)
+            {
+                // the UV plane cannot be cropped along with the Y plane
+                CV_Assert(frame.type() == CV_8UC1 && frame.rows % 3 == 0);
+                cv::cvtColor(frame, this->tile_bgr_, cv::COLOR_YUV2BGR_NV12);
+                src = &this->tile_bgr_;
+                src_format = PixelFormat::BGR;
+            }
+            // packed 4:2:2 crops must start and end on a pixel pair
+            const int align = (src_format == PixelFormat::YUYV || src_format == PixelFormat::UYVY) ? 2 : 1;
+            const int tile_w = std::min(src->cols, this->tile_w_ > 0 ? this->tile_w_ : this->input_w_) / align * align;
+            const int tile_h = std::min(src->rows, this->tile_h_ > 0 ? this->tile_h_ : this->input_h_);
+            tile_origins(src->cols, tile_w, align, this->tile_x_);
+            tile_origins(src->rows, tile_h, 1, this->tile_y_);
+
+            this->tiles_.clear();
+            this->tile_offsets_.clear();
+            for (const int y : this->tile_y_)
+            {
+                for (const int x : this->tile_x_)
+                {
+                    this->tiles_.emplace_back((*src)(cv::Rect(x, y, tile_w, tile_h)));
+                    this->tile_offsets_.emplace_back(x, y);
+                }
+            }
+            if (this->tile_global_view_ && this->tiles_.size() > 1)
+            {
+                this->tiles_.emplace_back(*src);
+                this->tile_offsets_.emplace_back(0, 0);
+            }
+
+            merge_tiles(this->inference_batch(this->tiles_, src_format), src->size(), objects);
+        }
+
+        // Models exported with decode (DECODED) or decode and NMS (NMS) in the graph.
+        // NMS outputs have a variable number of rows and need supports_nms_output().
+        void set_output_format(const OutputFormat format)
+        {
+            if (format == OutputFormat::NMS)
+            {
+                if (!this->supports_nms_output())
+                {
+                    throw std::runtime_error("in-graph NMS outputs are not supported by this backend");
+                }
+                this->check_nms_output();
+            }
+            this->output_format_ = format;
+        }
+
+        virtual bool supports_nms_output() const
+        {
+            return false;
+        }
+
+        OutputFormat output_format() const
+        {
+            return this->output_format_;
+        }
+
+        void set_nms_method(const NmsMethod method)
+        {
+            this->nms_method_ = method;
+        }
+
+        // false: boxes only suppress boxes of the same class
+        void set_class_agnostic_nms(const bool class_agnostic)
+        {
+            this->class_agnostic_nms_ = class_agnostic;
+        }
+
+        // keep at most max_proposals highest-scoring proposals before NMS (<= 0: no limit)
+        void set_max_proposals(const int max_proposals)
+        {
+            this->max_proposals_ = max_proposals;
+        }
+
+        // Stage timing for last_stage_times(). Off by default; when off no clock is read.
+        void set_profiling(const bool enable)
+        {
+            this->profiling_ = enable;
+        }
+
+        const StageTimes &last_stage_times() const
+        {
+            return this->stage_times_;
         }
-        virtual std::vector<Object> inference(const cv::Mat &frame) = 0;
 
     protected:
+        // Throws if output 0 of the model cannot be read as float32 [N, 7] detections
+        virtual void check_nms_output() const
+        {
+        }
+
         int input_w_;
         int input_h_;
         float nms_thresh_;
@@ -57,7 +531,209 @@ namespace yolox_cpp
             -0.485 / 0.229, -0.456 / 0.224, -0.406 / 0.225};
         const std::vector<int> strides_ = {8, 16, 32};
         const std::vector<int> strides_p6_ = {8, 16, 32, 64};
-        std::vector<GridAndStride> grid_strides_;
+        AnchorTable anchor_table_;
+        // dynamic input: anchor tables of the sizes not in use, see use_input_size
+        std::vector<std::pair<cv::Size, AnchorTable>> anchor_cache_;
+        int dynamic_max_w_ = 0;
+        int dynamic_max_h_ = 0;
+        cv::Size fixed_input_size_;
+        LetterboxTable letterbox_table_;
+        // output of static_resize, reused while the input size does not change
+        cv::Mat resized_;
+        // blob = img * input_scale_ + input_bias_, per channel
+        NormalizeMode normalize_mode_ = NormalizeMode::NONE;
+        float input_scale_[3] = {1.0f, 1.0f, 1.0f};
+        float input_bias_[3] = {0.0f, 0.0f, 0.0f};
+        OutputFormat output_format_ = OutputFormat::RAW;
+        NmsMethod nms_method_ = NmsMethod::REFERENCE;
+        bool class_agnostic_nms_ = true;
+        int max_proposals_ = 0;
+        DecodeScratch decode_scratch_;
+        // detections of the ObjectArrays overload before they are split into fields
+        std::vector<Object> result_scratch_;
+        // tiled inference, see set_tiling
+        int tile_w_ = 0;
+        int tile_h_ = 0;
+        float tile_overlap_ = 0.2f;
+        bool tile_global_view_ = true;
+        std::vector<int> tile_x_;
+        std::vector<int> tile_y_;
+        std::vector<cv::Mat> tiles_;
+        std::vector<cv::Point> tile_offsets_;
+        cv::Mat tile_bgr_;
+        DecodeScratch tile_scratch_;
+        // one per frame of inference_batch
+        std::vector<DecodeScratch> batch_scratch_;
+        bool profiling_ = false;
+        StageTimes stage_times_;
+        // letterbox time since the last finished decode, and when the last letterbox ended
+        double preprocess_us_ = 0.0;
+        std::chrono::steady_clock::time_point preprocess_end_;
+        // class-aware NMS runs buckets in parallel from this many proposals on
+        static constexpr size_t class_nms_parallel_min_ = 512;
+        // GRID NMS buckets the model input into nms_grid_size_ x nms_grid_size_ cells
+        static constexpr int nms_grid_size_ = 16;
+
+        static double elapsed_us(const std::chrono::steady_clock::time_point &from,
+                                 const std::chrono::steady_clock::time_point &to)
+        {
+            return std::chrono::duration<double, std::micro>(to - from).count();
+        }
+
+        // Smallest input of the same scale as letterboxing frame_w x frame_h into the
+        // dynamic maximum, rounded up to the largest stride.
+        cv::Size select_input_size(const int frame_w, const int frame_h) const
+        {
+            const int align = this->p6_ ? this->strides_p6_.back() : this->strides_.back();
+            const float r = std::min(
+                static_cast<float>(this->dynamic_max_w_) / static_cast<float>(frame_w),
+                static_cast<float>(this->dynamic_max_h_) / static_cast<float>(frame_h));
+            const auto round_up = [align](const float v)
+            {
+                return (static_cast<int>(std::ceil(v)) + align - 1) / align * align;
+            };
+            return cv::Size(std::min(round_up(r * frame_w), this->dynamic_max_w_ / align * align),
+                            std::min(round_up(r * frame_h), this->dynamic_max_h_ / align * align));
+        }
+
+        // Makes size the current input size. The anchor table of the previous size is kept
+        // in anchor_cache_ and swapped back in when that size comes again.
+        void use_input_size(const cv::Size &size)
+        {
+            const cv::Size current(this->input_w_, this->input_h_);
+            if (size == current)
+            {
+                return;
+            }
+            auto cached = std::find_if(this->anchor_cache_.begin(), this->anchor_cache_.end(),
+                                       [&size](const std::pair<cv::Size, AnchorTable> &entry)
+                                       { return entry.first == size; });
+            if (cached != this->anchor_cache_.end())
+            {
+                std::swap(cached->second, this->anchor_table_);
+                cached->first = current;
+            }
+            else
+            {
+                this->anchor_cache_.emplace_back(current, std::move(this->anchor_table_));
+                this->anchor_table_ = AnchorTable();
+                generate_anchor_table(size.width, size.height, this->p6_ ? this->strides_p6_ : this->strides_,
+                                      this->anchor_table_);
+            }
+            this->input_w_ = size.width;
+            this->input_h_ = size.height;
+        }
+
+        // Origins of tiles of size tile covering [0, length), overlapping by tile_overlap_.
+        // The last tile is shifted back to end at the border.
+        void tile_origins(const int length, const int tile, const int align, std::vector<int> &origins) const
+        {
+            origins.clear();
+            const int stride = std::max(align, static_cast<int>(tile * (1.0f - this->tile_overlap_)) / align * align);
+            for (int origin = 0;; origin += stride)
+            {
+                if (origin + tile >= length)
+                {
+                    origins.push_back((length - tile) / align * align);
+                    break;
+                }
+                origins.push_back(origin);
+            }
+        }
+
+        // Moves the detections of every tile to the coordinates of a frame of frame_size
+        // and suppresses the duplicates of objects seen by several tiles.
+        void merge_tiles(const std::vector<std::vector<Object>> &results, const cv::Size &frame_size,
+                         std::vector<Object> &objects)
+        {
+            std::chrono::steady_clock::time_point t_start;
+            if (this->profiling_)
+            {
+                t_start = std::chrono::steady_clock::now();
+            }
+            DecodeScratch &scratch = this->tile_scratch_;
+            std::vector<Object> &merged = scratch.proposals;
+            merged.clear();
+            for (size_t t = 0; t < results.size(); ++t)
+            {
+                const cv::Point &offset = this->tile_offsets_[t];
+                for (Object obj : results[t])
+                {
+                    obj.rect.x += offset.x;
+                    obj.rect.y += offset.y;
+                    merged.push_back(obj);
+                }
+            }
+            std::sort(merged.begin(), merged.end(), [](const Object &a, const Object &b)
+                      { return a.prob > b.prob; });
+
+            // the merged boxes are in frame pixels, not model input pixels
+            std::vector<int> &picked = scratch.picked;
+            if (this->class_agnostic_nms_)
+            {
+                run_nms(merged, picked, nms_thresh_, scratch.nms, frame_size);
+            }
+            else
+            {
+                batched_nms(merged, picked, nms_thresh_, scratch.class_buckets, frame_size);
+            }
+            objects.resize(picked.size());
+            for (size_t i = 0; i < picked.size(); ++i)
+            {
+                objects[i] = merged[picked[i]];
+            }
+            if (this->profiling_)
+            {
+                this->stage_times_.nms += elapsed_us(t_start, std::chrono::steady_clock::now());
+            }
+        }
+
+        static void to_arrays(const std::vector<Object> &objects, ObjectArrays &arrays)
+        {
+            const size_t n = objects.size();
+            arrays.x.resize(n);
+            arrays.y.resize(n);
+            arrays.width.resize(n);
+            arrays.height.resize(n);
+            arrays.prob.resize(n);
+            arrays.label.resize(n);
+            for (size_t i = 0; i < n; ++i)
+            {
+                arrays.x[i] = objects[i].rect.x;
+                arrays.y[i] = objects[i].rect.y;
+                arrays.width[i] = objects[i].rect.width;
+                arrays.height[i] = objects[i].rect.height;
+                arrays.prob[i] = objects[i].prob;
+                arrays.label[i] = objects[i].label;
+            }
+        }
+
+        // Closes the stage times of one inference call whose decode started at decode_start
+        void finish_stage_times(const std::chrono::steady_clock::time_point &decode_start,
+                                const DecodeScratch *scratch, const size_t num_scratch)
+        {
+            StageTimes &times = this->stage_times_;
+            times.preprocess = this->preprocess_us_;
+            times.infer = elapsed_us(this->preprocess_end_, decode_start);
+            times.decode = 0.0;
+            times.nms = 0.0;
+            for (size_t i = 0; i < num_scratch; ++i)
+            {
+                times.decode += scratch[i].decode_us;
+                times.nms += scratch[i].nms_us;
+            }
+            this->preprocess_us_ = 0.0;
+        }
+
+        void set_normalize_mode(const NormalizeMode mode)
+        {
+            this->normalize_mode_ = mode;
+            for (int c = 0; c < 3; ++c)
+            {
+                this->input_scale_[c] = (mode == NormalizeMode::MEAN_STD) ? this->std255_inv_[c] : 1.0f;
+                this->input_bias_[c] = (mode == NormalizeMode::MEAN_STD) ? this->mean_std_[c] : 0.0f;
+            }
+        }
 
         cv::Mat static_resize(const cv::Mat &img)
         {
@@ -66,70 +742,295 @@ namespace yolox_cpp
                 static_cast<float>(input_h_) / static_cast<float>(img.rows));
             const int unpad_w = r * img.cols;
             const int unpad_h = r * img.rows;
-            cv::Mat re(unpad_h, unpad_w, CV_8UC3);
+            // resized in place into the top-left of the reused buffer, then padded
+            this->resized_.create(input_h_, input_w_, CV_8UC3);
+            cv::Mat re = this->resized_(cv::Rect(0, 0, unpad_w, unpad_h));
             cv::resize(img, re, re.size());
-            cv::Mat out(input_h_, input_w_, CV_8UC3, cv::Scalar(114, 114, 114));
-            re.copyTo(out(cv::Rect(0, 0, re.cols, re.rows)));
-            return out;
+            const cv::Scalar pad(114, 114, 114);
+            if (unpad_w < input_w_)
+            {
+                this->resized_(cv::Rect(unpad_w, 0, input_w_ - unpad_w, input_h_)).setTo(pad);
+            }
+            if (unpad_h < input_h_)
+            {
+                this->resized_(cv::Rect(0, unpad_h, unpad_w, input_h_ - unpad_h)).setTo(pad);
+            }
+            return this->resized_;
         }
 
         // for NCHW
         void blobFromImage(const cv::Mat &img, float *blob_data)
         {
-            const size_t channels = 3;
-            const size_t img_h = img.rows;
             const size_t img_w = img.cols;
-            const size_t img_hw = img_h * img_w;
+            const size_t img_hw = img.rows * img_w;
             float *blob_data_ch0 = blob_data;
             float *blob_data_ch1 = blob_data + img_hw;
             float *blob_data_ch2 = blob_data + img_hw * 2;
             // HWC -> CHW
-            if (this->model_version_ == "0.1.0")
+            const int rows = img.isContinuous() ? 1 : img.rows;
+            const size_t row_len = img.isContinuous() ? img_hw : img_w;
+            for (int y = 0; y < rows; ++y)
+            {
+                const size_t ofs = y * row_len;
+                simd::bgr_to_planar_f32(
+                    img.ptr<uint8_t>(y), blob_data_ch0 + ofs, blob_data_ch1 + ofs, blob_data_ch2 + ofs,
+                    row_len, this->input_scale_, this->input_bias_);
+            }
+        }
+
+        // for NHWC
+        void blobFromImage_nhwc(const cv::Mat &img, float *blob_data)
+        {
+            const size_t channels = 3;
+            const int rows = img.isContinuous() ? 1 : img.rows;
+            const size_t row_len = img.isContinuous() ? img.total() : static_cast<size_t>(img.cols);
+            for (int y = 0; y < rows; ++y)
             {
-                for (size_t i = 0; i < img_hw; ++i)
+                simd::bgr_to_interleaved_f32(
+                    img.ptr<uint8_t>(y), blob_data + y * row_len * channels,
+                    row_len, this->input_scale_, this->input_bias_);
+            }
+        }
+
+        // Letterbox resize fused with colour conversion, normalization and HWC -> CHW
+        // conversion. Samples the source frame directly into the blob (padding is written
+        // as 114), so no resized or padded intermediate image is allocated.
+        void blobFromImage_letterbox(const cv::Mat &img, const PixelFormat format, float *blob_data)
+        {
+            letterbox_to_blob(img, format, blob_data, true);
+        }
+
+        // Same as blobFromImage_letterbox, for NHWC
+        void blobFromImage_letterbox_nhwc(const cv::Mat &img, const PixelFormat format, float *blob_data)
+        {
+            letterbox_to_blob(img, format, blob_data, false);
+        }
+
+        // Quantized (uint8 / int8) input tensors, written directly from the letterboxed
+        // frame: q = round(normalized / quant.scale) + quant.zero_point, saturated.
+        template <typename T>
+        void blobFromImage_letterbox(const cv::Mat &img, const PixelFormat format, T *blob_data, const Quantization &quant)
+        {
+            letterbox_to_blob(img, format, blob_data, true, quant);
+        }
+
+        template <typename T>
+        void blobFromImage_letterbox_nhwc(const cv::Mat &img, const PixelFormat format, T *blob_data, const Quantization &quant)
+        {
+            letterbox_to_blob(img, format, blob_data, false, quant);
+        }
+
+        // Same sampling grid as cv::resize with INTER_LINEAR
+        static void build_bilinear_taps(const int src_len, const int dst_len, const int elem_size,
+                                        std::vector<int> &ofs0, std::vector<int> &ofs1, std::vector<float> &alpha)
+        {
+            const double scale = static_cast<double>(src_len) / static_cast<double>(dst_len);
+            ofs0.resize(dst_len);
+            ofs1.resize(dst_len);
+            alpha.resize(dst_len);
+            for (int d = 0; d < dst_len; ++d)
+            {
+                float f = static_cast<float>((d + 0.5) * scale - 0.5);
+                int s = static_cast<int>(std::floor(f));
+                f -= s;
+                if (s < 0)
+                {
+                    s = 0;
+                    f = 0.f;
+                }
+                if (s >= src_len - 1)
                 {
-                    // blob = (img / 255.0 - mean) / std
-                    const size_t src_idx = i * channels;
-                    blob_data_ch0[i] = static_cast<float>(img.data[src_idx + 0]) * this->std255_inv_[0] + this->mean_std_[0];
-                    blob_data_ch1[i] = static_cast<float>(img.data[src_idx + 1]) * this->std255_inv_[1] + this->mean_std_[1];
-                    blob_data_ch2[i] = static_cast<float>(img.data[src_idx + 2]) * this->std255_inv_[2] + this->mean_std_[2];
+                    s = src_len - 1;
+                    f = 0.f;
                 }
+                ofs0[d] = s * elem_size;
+                ofs1[d] = std::min(s + 1, src_len - 1) * elem_size;
+                alpha[d] = f;
+            }
+        }
+
+        void update_letterbox_table(const int src_w, const int src_h)
+        {
+            LetterboxTable &table = this->letterbox_table_;
+            if (table.src_w == src_w && table.src_h == src_h && table.dst_w == input_w_ && table.dst_h == input_h_)
+            {
+                return;
+            }
+            const float r = std::min(
+                static_cast<float>(input_w_) / static_cast<float>(src_w),
+                static_cast<float>(input_h_) / static_cast<float>(src_h));
+            table.src_w = src_w;
+            table.src_h = src_h;
+            table.dst_w = input_w_;
+            table.dst_h = input_h_;
+            table.unpad_w = r * src_w;
+            table.unpad_h = r * src_h;
+            build_bilinear_taps(src_w, table.unpad_w, 3, table.x_ofs0, table.x_ofs1, table.x_alpha);
+            build_bilinear_taps(src_h, table.unpad_h, 1, table.y_ofs0, table.y_ofs1, table.y_alpha);
+        }
+
+        // Rounds and saturates to T; float passes through
+        template <typename T>
+        static T saturate_to(const float v)
+        {
+            if constexpr (std::is_same<T, float>::value)
+            {
+                return v;
             }
             else
             {
-                for (size_t i = 0; i < img_hw; ++i)
-                {
-                    const size_t src_idx = i * channels;
-                    blob_data_ch0[i] = static_cast<float>(img.data[src_idx + 0]);
-                    blob_data_ch1[i] = static_cast<float>(img.data[src_idx + 1]);
-                    blob_data_ch2[i] = static_cast<float>(img.data[src_idx + 2]);
-                }
+                const float lo = static_cast<float>(std::numeric_limits<T>::min());
+                const float hi = static_cast<float>(std::numeric_limits<T>::max());
+                return static_cast<T>(std::min(std::max(std::nearbyint(v), lo), hi));
             }
         }
 
-        // for NHWC
-        void blobFromImage_nhwc(const cv::Mat &img, float *blob_data)
+        template <typename T>
+        void letterbox_to_blob(const cv::Mat &img, const PixelFormat format, T *blob_data, const bool nchw,
+                               const Quantization &quant = Quantization())
         {
-            const size_t channels = 3;
-            cv::Mat img_f32;
-            img.convertTo(img_f32, CV_32FC3);
-            if (this->model_version_ == "0.1.0")
+            std::chrono::steady_clock::time_point start;
+            if (this->profiling_)
+            {
+                start = std::chrono::steady_clock::now();
+            }
+            switch (format)
+            {
+            case PixelFormat::BGR:
+            case PixelFormat::RGB:
+                CV_Assert(img.type() == CV_8UC3);
+                break;
+            case PixelFormat::YUYV:
+            case PixelFormat::UYVY:
+                CV_Assert(img.type() == CV_8UC2 && img.cols % 2 == 0);
+                break;
+            case PixelFormat::NV12:
+                // a whole number of Y rows and UV rows (so an even image height)
+                CV_Assert(img.type() == CV_8UC1 && img.cols % 2 == 0 && img.rows % 3 == 0);
+                break;
+            }
+            const bool is_bgr = (format == PixelFormat::BGR);
+            const cv::Size size = image_size(img, format);
+            this->update_letterbox_table(size.width, size.height);
+            const LetterboxTable &table = this->letterbox_table_;
+
+            // quantization is folded into the per-channel normalization
+            float scale[3];
+            float bias[3];
+            T pad[3];
+            for (int c = 0; c < 3; ++c)
+            {
+                scale[c] = this->input_scale_[c] / quant.scale;
+                bias[c] = this->input_bias_[c] / quant.scale + quant.zero_point;
+                pad[c] = saturate_to<T>(114.0f * scale[c] + bias[c]);
+            }
+
+            const int out_w = input_w_;
+            const int out_h = input_h_;
+            const size_t px_step = nchw ? 1 : 3;
+            const size_t ch_step = nchw ? static_cast<size_t>(out_w) * out_h : 1;
+            const bool same_size = (table.unpad_w == size.width && table.unpad_h == size.height);
+
+            const auto convert_rows = [&](const cv::Range &range)
             {
-                std::vector<cv::Mat> img_f32_split(3);
-                cv::split(img_f32, img_f32_split);
-                for (size_t i = 0; i < channels; ++i)
+                // other layouts: the two source rows of each output row, converted to BGR.
+                // Kept per worker thread so repeated calls do not allocate.
+                thread_local std::vector<uint8_t> bgr_rows;
+                int bgr_row_y[2] = {-1, -1};
+                auto source_row = [&](const int src_y, const int slot) -> const uint8_t *
                 {
-                    img_f32_split[i] *= this->std255_inv_[i];
-                    img_f32_split[i] += this->mean_std_[i];
+                    if (is_bgr)
+                    {
+                        return img.ptr<uint8_t>(src_y);
+                    }
+                    if (bgr_rows.size() < static_cast<size_t>(img.cols) * 3 * 2)
+                    {
+                        bgr_rows.resize(static_cast<size_t>(img.cols) * 3 * 2);
+                    }
+                    uint8_t *row = bgr_rows.data() + static_cast<size_t>(img.cols) * 3 * slot;
+                    if (bgr_row_y[slot] != src_y)
+                    {
+                        convert_row_to_bgr(img, format, src_y, row);
+                        bgr_row_y[slot] = src_y;
+                    }
+                    return row;
+                };
+
+                for (int y = range.start; y < range.end; ++y)
+                {
+                    T *dst = blob_data + static_cast<size_t>(y) * out_w * px_step;
+                    int x = 0;
+                    if (y < table.unpad_h && same_size)
+                    {
+                        const uint8_t *src = source_row(y, 0);
+                        if constexpr (std::is_same<T, float>::value)
+                        {
+                            if (nchw)
+                            {
+                                simd::bgr_to_planar_f32(src, dst, dst + ch_step, dst + ch_step * 2, table.unpad_w, scale, bias);
+                            }
+                            else
+                            {
+                                simd::bgr_to_interleaved_f32(src, dst, table.unpad_w, scale, bias);
+                            }
+                        }
+                        else
+                        {
+                            for (int i = 0; i < table.unpad_w; ++i)
+                            {
+                                for (int c = 0; c < 3; ++c)
+                                {
+                                    dst[i * px_step + c * ch_step] = saturate_to<T>(src[i * 3 + c] * scale[c] + bias[c]);
+                                }
+                            }
+                        }
+                        x = table.unpad_w;
+                    }
+                    else if (y < table.unpad_h)
+                    {
+                        const uint8_t *row0 = source_row(table.y_ofs0[y], 0);
+                        const uint8_t *row1 = source_row(table.y_ofs1[y], 1);
+                        const float ay = table.y_alpha[y];
+                        const float by = 1.0f - ay;
+                        for (; x < table.unpad_w; ++x)
+                        {
+                            const int o0 = table.x_ofs0[x];
+                            const int o1 = table.x_ofs1[x];
+                            const float ax = table.x_alpha[x];
+                            const float bx = 1.0f - ax;
+                            for (int c = 0; c < 3; ++c)
+                            {
+                                const float top = row0[o0 + c] * bx + row0[o1 + c] * ax;
+                                const float bottom = row1[o0 + c] * bx + row1[o1 + c] * ax;
+                                dst[x * px_step + c * ch_step] = saturate_to<T>((top * by + bottom * ay) * scale[c] + bias[c]);
+                            }
+                        }
+                    }
+                    // right / bottom padding
+                    for (; x < out_w; ++x)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                        {
+                            dst[x * px_step + c * ch_step] = pad[c];
+                        }
+                    }
                 }
-                cv::merge(img_f32_split, img_f32);
+            };
+            // by reference: a std::function holding the lambda itself would allocate every call
+            cv::parallel_for_(cv::Range(0, out_h), std::cref(convert_rows));
+
+            if (this->profiling_)
+            {
+                this->preprocess_end_ = std::chrono::steady_clock::now();
+                this->preprocess_us_ += elapsed_us(start, this->preprocess_end_);
             }
-            memcpy(blob_data, img_f32.data, img.rows * img.cols * channels * sizeof(float));
         }
 
-        void generate_grids_and_stride(const int target_w, const int target_h, const std::vector<int> &strides, std::vector<GridAndStride> &grid_strides)
+        void generate_anchor_table(const int target_w, const int target_h, const std::vector<int> &strides, AnchorTable &table)
         {
-            grid_strides.clear();
+            table.x.clear();
+            table.y.clear();
+            table.stride.clear();
             for (auto stride : strides)
             {
                 const int num_grid_w = target_w / stride;
@@ -138,57 +1039,125 @@ namespace yolox_cpp
                 {
                     for (int g0 = 0; g0 < num_grid_w; ++g0)
                     {
-                        grid_strides.emplace_back(g0, g1, stride);
+                        table.x.push_back(static_cast<float>(g0 * stride));
+                        table.y.push_back(static_cast<float>(g1 * stride));
+                        table.stride.push_back(static_cast<float>(stride));
                     }
                 }
             }
         }
 
-        void generate_yolox_proposals(const std::vector<GridAndStride> &grid_strides, const float *feat_ptr, const float prob_threshold, std::vector<Object> &objects)
+        void generate_yolox_proposals(const AnchorTable &anchors, const float *feat_ptr, const float prob_threshold, std::vector<Object> &objects)
         {
-            const int num_anchors = grid_strides.size();
-            objects.clear();
+            generate_yolox_proposals(anchors, feat_ptr, prob_threshold, objects, this->decode_scratch_);
+        }
 
-            for (int anchor_idx = 0; anchor_idx < num_anchors; ++anchor_idx)
-            {
-                const int grid0 = grid_strides[anchor_idx].grid0;
-                const int grid1 = grid_strides[anchor_idx].grid1;
-                const int stride = grid_strides[anchor_idx].stride;
+        void generate_yolox_proposals(const AnchorTable &anchors, const float *feat_ptr, const float prob_threshold, std::vector<Object> &objects,
+                                      DecodeScratch &scratch)
+        {
+            const int num_anchors = anchors.size();
+            const int num_attrs = num_classes_ + 5;
+            std::vector<int> &candidate_anchors = scratch.candidate_anchors;
+            objects.clear();
 
-                const int basic_pos = anchor_idx * (num_classes_ + 5);
+            // Class scores are <= 1, so an anchor whose objectness alone does not exceed
+            // the threshold can never pass. Reject those first with a strided scan and
+            // only compute the class argmax for the few survivors.
+            candidate_anchors.resize(num_anchors);
+            const size_t num_candidates = simd::filter_greater(
+                feat_ptr + 4, num_anchors, num_attrs, prob_threshold, candidate_anchors.data());
 
-                int class_id = 0;
-                float max_class_score = 0.0f;
-                {
-                    const float box_objectness = feat_ptr[basic_pos + 4];
-                    auto begin = feat_ptr + (basic_pos + 5);
-                    auto end = feat_ptr + (basic_pos + 5 + num_classes_);
-                    auto max_elem = std::max_element(begin, end);
-                    class_id = max_elem - begin;
-                    max_class_score = (*max_elem) * box_objectness;
-                }
+            // Class argmax of the candidates. Proposals are compacted to the front of
+            // candidate_anchors and their boxes decoded afterwards in one vector pass.
+            size_t num_proposals = 0;
+            for (size_t i = 0; i < num_candidates; ++i)
+            {
+                const int anchor_idx = candidate_anchors[i];
+                const int basic_pos = anchor_idx * num_attrs;
+                const float box_objectness = feat_ptr[basic_pos + 4];
+                auto begin = feat_ptr + (basic_pos + 5);
+                auto end = feat_ptr + (basic_pos + 5 + num_classes_);
+                auto max_elem = std::max_element(begin, end);
+                const float max_class_score = (*max_elem) * box_objectness;
                 if (max_class_score > prob_threshold)
                 {
-                    // yolox/models/yolo_head.py decode logic
-                    //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
-                    //  outputs[..., 2:4] = torch.exp(outputs[..., 2:4]) * strides
-                    const float x_center = (feat_ptr[basic_pos + 0] + grid0) * stride;
-                    const float y_center = (feat_ptr[basic_pos + 1] + grid1) * stride;
-                    const float w = exp(feat_ptr[basic_pos + 2]) * stride;
-                    const float h = exp(feat_ptr[basic_pos + 3]) * stride;
-                    const float x0 = x_center - w * 0.5f;
-                    const float y0 = y_center - h * 0.5f;
-
                     Object obj;
-                    obj.rect.x = x0;
-                    obj.rect.y = y0;
-                    obj.rect.width = w;
-                    obj.rect.height = h;
-                    obj.label = class_id;
+                    obj.label = max_elem - begin;
                     obj.prob = max_class_score;
                     objects.push_back(obj);
+                    candidate_anchors[num_proposals++] = anchor_idx;
+                }
+            }
+
+            if (this->output_format_ == OutputFormat::DECODED)
+            {
+                // decoded in the graph: cx, cy, w, h
+                for (size_t i = 0; i < num_proposals; ++i)
+                {
+                    const float *reg = feat_ptr + static_cast<size_t>(candidate_anchors[i]) * num_attrs;
+                    objects[i].rect.x = reg[0] - reg[2] * 0.5f;
+                    objects[i].rect.y = reg[1] - reg[3] * 0.5f;
+                    objects[i].rect.width = reg[2];
+                    objects[i].rect.height = reg[3];
                 }
-            } // point anchor loop
+                return;
+            }
+
+            // yolox/models/yolo_head.py decode logic
+            //  outputs[..., :2] = (outputs[..., :2] + grids) * strides
+            //  outputs[..., 2:4] = torch.exp(outputs[..., 2:4]) * strides
+            scratch.boxes.resize(num_proposals * 4);
+            simd::decode_boxes(feat_ptr, num_attrs, candidate_anchors.data(), num_proposals,
+                               anchors.x.data(), anchors.y.data(), anchors.stride.data(), scratch.boxes.data());
+            const float *x0 = scratch.boxes.data();
+            const float *y0 = x0 + num_proposals;
+            const float *w = y0 + num_proposals;
+            const float *h = w + num_proposals;
+            for (size_t i = 0; i < num_proposals; ++i)
+            {
+                objects[i].rect.x = x0[i];
+                objects[i].rect.y = y0[i];
+                objects[i].rect.width = w[i];
+                objects[i].rect.height = h[i];
+            }
+        }
+
+        // float outputs are not quantized
+        void generate_yolox_proposals(const AnchorTable &anchors, const float *feat_ptr, const Quantization &,
+                                      const float prob_threshold, std::vector<Object> &objects, DecodeScratch &scratch)
+        {
+            generate_yolox_proposals(anchors, feat_ptr, prob_threshold, objects, scratch);
+        }
+
+        // uint8 / int8 (with quant) or fp16 head output. Only the rows of anchors that pass
+        // the objectness threshold are converted to float, then decoded like a float output.
+        template <typename T>
+        void generate_yolox_proposals(const AnchorTable &anchors, const T *feat_ptr, const Quantization &quant,
+                                      const float prob_threshold, std::vector<Object> &objects, DecodeScratch &scratch)
+        {
+            const int num_anchors = anchors.size();
+            const int num_attrs = num_classes_ + 5;
+            std::vector<float> &rows = scratch.dequant_rows;
+            AnchorTable &row_anchors = scratch.dequant_anchors;
+            rows.clear();
+            row_anchors.x.clear();
+            row_anchors.y.clear();
+            row_anchors.stride.clear();
+            for (int i = 0; i < num_anchors; ++i)
+            {
+                const T *row = feat_ptr + static_cast<size_t>(i) * num_attrs;
+                if (!(to_f32(row[4], quant) > prob_threshold))
+                {
+                    continue;
+                }
+                const size_t offset = rows.size();
+                rows.resize(offset + num_attrs);
+                to_f32(row, num_attrs, quant, rows.data() + offset);
+                row_anchors.x.push_back(anchors.x[i]);
+                row_anchors.y.push_back(anchors.y[i]);
+                row_anchors.stride.push_back(anchors.stride[i]);
+            }
+            generate_yolox_proposals(row_anchors, rows.data(), prob_threshold, objects, scratch);
         }
 
         float intersection_area(const Object &a, const Object &b)
@@ -198,12 +1167,19 @@ namespace yolox_cpp
         }
 
         void nms_sorted_bboxes(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold)
+        {
+            nms_sorted_bboxes(faceobjects, picked, nms_threshold, this->decode_scratch_.nms);
+        }
+
+        void nms_sorted_bboxes(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold,
+                               NmsScratch &scratch)
         {
             picked.clear();
 
             const int n = faceobjects.size();
 
-            std::vector<float> areas(n);
+            std::vector<float> &areas = scratch.area;
+            areas.resize(n);
             for (int i = 0; i < n; ++i)
             {
                 areas[i] = faceobjects[i].rect.area();
@@ -235,49 +1211,405 @@ namespace yolox_cpp
             }
         }
 
-        void decode_outputs(const float *prob, const std::vector<GridAndStride> &grid_strides,
+        // Equivalent to nms_sorted_bboxes. Picked boxes are appended to corner / area
+        // arrays so the IoU test against all of them is a single vectorized scan.
+        void nms_sorted_bboxes_soa(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold,
+                                   NmsScratch &scratch)
+        {
+            picked.clear();
+
+            const int n = faceobjects.size();
+            scratch.x0.resize(n);
+            scratch.y0.resize(n);
+            scratch.x1.resize(n);
+            scratch.y1.resize(n);
+            scratch.area.resize(n);
+
+            size_t num_picked = 0;
+            for (int i = 0; i < n; ++i)
+            {
+                const cv::Rect_<float> &r = faceobjects[i].rect;
+                const float box[4] = {r.x, r.y, r.x + r.width, r.y + r.height};
+                const float area = r.area();
+                if (simd::any_iou_greater(scratch.x0.data(), scratch.y0.data(), scratch.x1.data(), scratch.y1.data(),
+                                          scratch.area.data(), num_picked, box, area, nms_threshold))
+                {
+                    continue;
+                }
+                scratch.x0[num_picked] = box[0];
+                scratch.y0[num_picked] = box[1];
+                scratch.x1[num_picked] = box[2];
+                scratch.y1[num_picked] = box[3];
+                scratch.area[num_picked] = area;
+                ++num_picked;
+                picked.push_back(i);
+            }
+        }
+
+        // Equivalent to nms_sorted_bboxes. Picked boxes are registered in every cell of a
+        // coarse grid over extent (the coordinate range of the boxes) that they touch, so a
+        // candidate is only tested against picked boxes sharing a cell with it (boxes that
+        // overlap always do).
+        void nms_sorted_bboxes_grid(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold,
+                                    NmsScratch &scratch, const cv::Size &extent)
+        {
+            picked.clear();
+
+            const int n = faceobjects.size();
+            const int grid = nms_grid_size_;
+            const float cell_w = static_cast<float>(std::max(extent.width, grid)) / grid;
+            const float cell_h = static_cast<float>(std::max(extent.height, grid)) / grid;
+            scratch.cells.resize(grid * grid);
+            for (auto &cell : scratch.cells)
+            {
+                cell.clear();
+            }
+            scratch.visited.assign(n, -1);
+            scratch.area.resize(n);
+            for (int i = 0; i < n; ++i)
+            {
+                scratch.area[i] = faceobjects[i].rect.area();
+            }
+
+            const auto to_cell = [grid](const float v, const float cell_size)
+            {
+                return std::min(std::max(static_cast<int>(std::floor(v / cell_size)), 0), grid - 1);
+            };
+
+            for (int i = 0; i < n; ++i)
+            {
+                const Object &a = faceobjects[i];
+                const int cx0 = to_cell(a.rect.x, cell_w);
+                const int cy0 = to_cell(a.rect.y, cell_h);
+                const int cx1 = to_cell(a.rect.x + a.rect.width, cell_w);
+                const int cy1 = to_cell(a.rect.y + a.rect.height, cell_h);
+
+                bool keep = true;
+                for (int cy = cy0; cy <= cy1 && keep; ++cy)
+                {
+                    for (int cx = cx0; cx <= cx1 && keep; ++cx)
+                    {
+                        for (const int j : scratch.cells[cy * grid + cx])
+                        {
+                            if (scratch.visited[j] == i)
+                            {
+                                continue;
+                            }
+                            scratch.visited[j] = i;
+
+                            // intersection over union
+                            const float inter_area = intersection_area(a, faceobjects[j]);
+                            const float union_area = scratch.area[i] + scratch.area[j] - inter_area;
+                            if (inter_area / union_area > nms_threshold)
+                            {
+                                keep = false;
+                                break;
+                            }
+                        }
+                    }
+                }
+
+                if (keep)
+                {
+                    picked.push_back(i);
+                    for (int cy = cy0; cy <= cy1; ++cy)
+                    {
+                        for (int cx = cx0; cx <= cx1; ++cx)
+                        {
+                            scratch.cells[cy * grid + cx].push_back(i);
+                        }
+                    }
+                }
+            }
+        }
+
+        // NMS of boxes in model input pixels
+        void run_nms(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold,
+                     NmsScratch &scratch)
+        {
+            run_nms(faceobjects, picked, nms_threshold, scratch, cv::Size(this->input_w_, this->input_h_));
+        }
+
+        // NMS of boxes within extent
+        void run_nms(const std::vector<Object> &faceobjects, std::vector<int> &picked, const float nms_threshold,
+                     NmsScratch &scratch, const cv::Size &extent)
+        {
+            switch (this->nms_method_)
+            {
+            case NmsMethod::SOA:
+                nms_sorted_bboxes_soa(faceobjects, picked, nms_threshold, scratch);
+                break;
+            case NmsMethod::GRID:
+                nms_sorted_bboxes_grid(faceobjects, picked, nms_threshold, scratch, extent);
+                break;
+            default:
+                nms_sorted_bboxes(faceobjects, picked, nms_threshold, scratch);
+                break;
+            }
+        }
+
+        // Class-aware NMS. Score-sorted proposals are split into per-class buckets, each
+        // bucket is suppressed on its own (in parallel when there are many proposals),
+        // and the picks are merged back in score order.
+        void batched_nms(const std::vector<Object> &proposals, std::vector<int> &picked, const float nms_threshold,
+                         ClassBuckets &buckets)
+        {
+            batched_nms(proposals, picked, nms_threshold, buckets, cv::Size(this->input_w_, this->input_h_));
+        }
+
+        void batched_nms(const std::vector<Object> &proposals, std::vector<int> &picked, const float nms_threshold,
+                         ClassBuckets &buckets, const cv::Size &extent)
+        {
+            buckets.objects.resize(num_classes_);
+            buckets.index.resize(num_classes_);
+            buckets.picked.resize(num_classes_);
+            buckets.scratch.resize(num_classes_);
+            buckets.active.clear();
+            for (int c = 0; c < num_classes_; ++c)
+            {
+                buckets.objects[c].clear();
+                buckets.index[c].clear();
+            }
+
+            const int n = proposals.size();
+            for (int i = 0; i < n; ++i)
+            {
+                const int label = proposals[i].label;
+                if (buckets.objects[label].empty())
+                {
+                    buckets.active.push_back(label);
+                }
+                buckets.objects[label].push_back(proposals[i]);
+                buckets.index[label].push_back(i);
+            }
+
+            const auto suppress = [&](const cv::Range &range)
+            {
+                for (int k = range.start; k < range.end; ++k)
+                {
+                    const int c = buckets.active[k];
+                    run_nms(buckets.objects[c], buckets.picked[c], nms_threshold, buckets.scratch[c], extent);
+                }
+            };
+            const cv::Range all_classes(0, static_cast<int>(buckets.active.size()));
+            if (proposals.size() >= class_nms_parallel_min_ && buckets.active.size() > 1)
+            {
+                cv::parallel_for_(all_classes, std::cref(suppress));
+            }
+            else
+            {
+                suppress(all_classes);
+            }
+
+            picked.clear();
+            for (const int c : buckets.active)
+            {
+                for (const int j : buckets.picked[c])
+                {
+                    picked.push_back(buckets.index[c][j]);
+                }
+            }
+            // proposals are sorted by score, so ascending index is descending score
+            std::sort(picked.begin(), picked.end());
+        }
+
+        void decode_outputs(const float *prob, const AnchorTable &anchors,
                             std::vector<Object> &objects, const float bbox_conf_thresh,
                             const float scale, const int img_w, const int img_h)
         {
+            decode_outputs(prob, Quantization(), anchors, objects, bbox_conf_thresh, scale, img_w, img_h);
+        }
 
-            std::vector<Object> proposals;
-            generate_yolox_proposals(grid_strides, prob, bbox_conf_thresh, proposals);
+        void decode_outputs(const float *prob, const AnchorTable &anchors,
+                            std::vector<Object> &objects, const float bbox_conf_thresh,
+                            const float scale, const int img_w, const int img_h,
+                            DecodeScratch &scratch)
+        {
+            decode_outputs(prob, Quantization(), anchors, objects, bbox_conf_thresh, scale, img_w, img_h, scratch);
+        }
 
-            std::sort(
-                proposals.begin(), proposals.end(),
-                [](const Object &a, const Object &b)
-                {
-                    return a.prob > b.prob; // descent
-                });
+        // Same for an output tensor of element type T: uint8 / int8 dequantized with quant,
+        // or Float16. Only the rows of candidate anchors are converted.
+        template <typename T>
+        void decode_outputs(const T *prob, const Quantization &quant, const AnchorTable &anchors,
+                            std::vector<Object> &objects, const float bbox_conf_thresh,
+                            const float scale, const int img_w, const int img_h)
+        {
+            if (!this->profiling_)
+            {
+                decode_outputs(prob, quant, anchors, objects, bbox_conf_thresh, scale, img_w, img_h, this->decode_scratch_);
+                return;
+            }
+            const auto decode_start = std::chrono::steady_clock::now();
+            decode_outputs(prob, quant, anchors, objects, bbox_conf_thresh, scale, img_w, img_h, this->decode_scratch_);
+            finish_stage_times(decode_start, &this->decode_scratch_, 1);
+        }
+
+        template <typename T>
+        void decode_outputs(const T *prob, const Quantization &quant, const AnchorTable &anchors,
+                            std::vector<Object> &objects, const float bbox_conf_thresh,
+                            const float scale, const int img_w, const int img_h,
+                            DecodeScratch &scratch)
+        {
+            std::chrono::steady_clock::time_point t_start, t_nms, t_nms_end;
+            if (this->profiling_)
+            {
+                t_start = std::chrono::steady_clock::now();
+            }
+            std::vector<Object> &proposals = scratch.proposals;
+            generate_yolox_proposals(anchors, prob, quant, bbox_conf_thresh, proposals, scratch);
 
-            std::vector<int> picked;
-            nms_sorted_bboxes(proposals, picked, nms_thresh_);
+            const auto by_score = [](const Object &a, const Object &b)
+            {
+                return a.prob > b.prob; // descent
+            };
+            if (this->max_proposals_ > 0 && proposals.size() > static_cast<size_t>(this->max_proposals_))
+            {
+                // top-k: only the kept part needs to be ordered
+                std::partial_sort(proposals.begin(), proposals.begin() + this->max_proposals_, proposals.end(), by_score);
+                proposals.resize(this->max_proposals_);
+            }
+            else
+            {
+                std::sort(proposals.begin(), proposals.end(), by_score);
+            }
+
+            if (this->profiling_)
+            {
+                t_nms = std::chrono::steady_clock::now();
+            }
+            std::vector<int> &picked = scratch.picked;
+            if (this->class_agnostic_nms_)
+            {
+                run_nms(proposals, picked, nms_thresh_, scratch.nms);
+            }
+            else
+            {
+                batched_nms(proposals, picked, nms_thresh_, scratch.class_buckets);
+            }
+            if (this->profiling_)
+            {
+                t_nms_end = std::chrono::steady_clock::now();
+            }
 
             int count = picked.size();
             objects.resize(count);
+            for (int i = 0; i < count; ++i)
+            {
+                objects[i] = proposals[picked[i]];
+                const cv::Rect_<float> &rect = objects[i].rect;
+                to_frame_rect(rect.x, rect.y, rect.x + rect.width, rect.y + rect.height,
+                              scale, img_w, img_h, objects[i].rect);
+            }
+
+            if (this->profiling_)
+            {
+                const auto t_end = std::chrono::steady_clock::now();
+                scratch.decode_us = elapsed_us(t_start, t_nms) + elapsed_us(t_nms_end, t_end);
+                scratch.nms_us = elapsed_us(t_nms, t_nms_end);
+            }
+        }
+
+        // Input pixel corners -> rect in the original, unpadded frame, clipped
+        static void to_frame_rect(float x0, float y0, float x1, float y1, const float scale,
+                                  const int img_w, const int img_h, cv::Rect_<float> &rect)
+        {
+            // adjust offset to original unpadded
             const float max_x = static_cast<float>(img_w - 1);
             const float max_y = static_cast<float>(img_h - 1);
+            x0 = std::max(std::min(x0 / scale, max_x), 0.f);
+            y0 = std::max(std::min(y0 / scale, max_y), 0.f);
+            x1 = std::max(std::min(x1 / scale, max_x), 0.f);
+            y1 = std::max(std::min(y1 / scale, max_y), 0.f);
+            rect.x = x0;
+            rect.y = y0;
+            rect.width = x1 - x0;
+            rect.height = y1 - y0;
+        }
 
-            for (int i = 0; i < count; ++i)
+        // Final detections of an in-graph NMS model (OutputFormat::NMS), num_rows x 7:
+        // batch, class, score, x0, y0, x1, y1 in input pixels. Only the score threshold
+        // and the letterbox are applied here. Models run one frame at a time, so rows of
+        // another batch index, and rows with a class outside num_classes, are dropped.
+        void decode_detections(const float *rows, const size_t num_rows, std::vector<Object> &objects,
+                               const float bbox_conf_thresh, const float scale, const int img_w, const int img_h)
+        {
+            if (!this->profiling_)
             {
-                objects[i] = proposals[picked[i]];
+                decode_detections(rows, num_rows, objects, bbox_conf_thresh, scale, img_w, img_h, this->decode_scratch_);
+                return;
+            }
+            const auto decode_start = std::chrono::steady_clock::now();
+            decode_detections(rows, num_rows, objects, bbox_conf_thresh, scale, img_w, img_h, this->decode_scratch_);
+            finish_stage_times(decode_start, &this->decode_scratch_, 1);
+        }
+
+        void decode_detections(const float *rows, const size_t num_rows, std::vector<Object> &objects,
+                               const float bbox_conf_thresh, const float scale, const int img_w, const int img_h,
+                               DecodeScratch &scratch)
+        {
+            std::chrono::steady_clock::time_point t_start;
+            if (this->profiling_)
+            {
+                t_start = std::chrono::steady_clock::now();
+            }
+            objects.clear();
+            for (size_t i = 0; i < num_rows; ++i)
+            {
+                const float *row = rows + i * 7;
+                if (row[0] != 0.0f || !(row[2] > bbox_conf_thresh))
+                {
+                    continue;
+                }
+                // compared as float first: casting nan or a huge value to int is undefined
+                if (!(row[1] >= 0.0f && row[1] < static_cast<float>(this->num_classes_)))
+                {
+                    continue;
+                }
+                Object obj;
+                obj.label = static_cast<int>(row[1]);
+                obj.prob = row[2];
+                to_frame_rect(row[3], row[4], row[5], row[6], scale, img_w, img_h, obj.rect);
+                objects.push_back(obj);
+            }
+            if (this->profiling_)
+            {
+                scratch.decode_us = elapsed_us(t_start, std::chrono::steady_clock::now());
+                scratch.nms_us = 0.0;
+            }
+        }
 
-                // adjust offset to original unpadded
-                float x0 = objects[i].rect.x / scale;
-                float y0 = objects[i].rect.y / scale;
-                float x1 = (objects[i].rect.x + objects[i].rect.width) / scale;
-                float y1 = (objects[i].rect.y + objects[i].rect.height) / scale;
-
-                // clip
-                x0 = std::max(std::min(x0, max_x), 0.f);
-                y0 = std::max(std::min(y0, max_y), 0.f);
-                x1 = std::max(std::min(x1, max_x), 0.f);
-                y1 = std::max(std::min(y1, max_y), 0.f);
-
-                objects[i].rect.x = x0;
-                objects[i].rect.y = y0;
-                objects[i].rect.width = x1 - x0;
-                objects[i].rect.height = y1 - y0;
+        // Decodes a batched output tensor, one slice of slice_size floats per frame,
+        // with the frames decoded in parallel.
+        void decode_outputs_batch(const float *prob, const size_t slice_size,
+                                  const std::vector<cv::Mat> &frames, const PixelFormat format,
+                                  std::vector<std::vector<Object>> &objects)
+        {
+            const int batch = frames.size();
+            objects.resize(batch);
+            this->batch_scratch_.resize(batch);
+            std::chrono::steady_clock::time_point decode_start;
+            if (this->profiling_)
+            {
+                decode_start = std::chrono::steady_clock::now();
+            }
+            const auto decode_frames = [&](const cv::Range &range)
+            {
+                for (int b = range.start; b < range.end; ++b)
+                {
+                    const cv::Size size = image_size(frames[b], format);
+                    const float scale = std::min(
+                        static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+                        static_cast<float>(this->input_h_) / static_cast<float>(size.height));
+                    decode_outputs(prob + b * slice_size, this->anchor_table_, objects[b],
+                                   this->bbox_conf_thresh_, scale, size.width, size.height,
+                                   this->batch_scratch_[b]);
+                }
+            };
+            cv::parallel_for_(cv::Range(0, batch), std::cref(decode_frames));
+            if (this->profiling_)
+            {
+                finish_stage_times(decode_start, this->batch_scratch_.data(), batch);
             }
         }
     };
@@ -0,0 +1,64 @@
+#ifndef _YOLOX_CPP_SIMD_HPP
+#define _YOLOX_CPP_SIMD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace yolox_cpp
+{
+    namespace simd
+    {
+        // Vectorized kernels are picked once at runtime from the instruction sets
+        // supported by the host (AVX-512 / AVX2 / SSE4.1 on x86, NEON on aarch64),
+        // with a scalar fallback.
+
+        // Name of the selected kernel set ("avx512", "avx2", "sse4.1", "neon" or "scalar")
+        const char *active_isa();
+
+        // Kernel sets usable on this host, best first ("scalar" is always last)
+        std::vector<std::string> available_isas();
+
+        // Switches every kernel to the named set of available_isas(), e.g. to compare a
+        // vector kernel set with "scalar". Returns false for an unknown or unsupported
+        // set. Not synchronized with kernels running on other threads.
+        bool set_isa(const std::string &name);
+
+        // BGR uint8 (interleaved) -> 3 float planes
+        //   dst_c[i] = src[i * 3 + c] * scale[c] + bias[c]
+        void bgr_to_planar_f32(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                               size_t num_pixels, const float *scale, const float *bias);
+
+        // BGR uint8 (interleaved) -> interleaved float
+        //   dst[i * 3 + c] = src[i * 3 + c] * scale[c] + bias[c]
+        void bgr_to_interleaved_f32(const uint8_t *src, float *dst,
+                                    size_t num_pixels, const float *scale, const float *bias);
+
+        // Strided threshold scan: writes every i with data[i * stride] > threshold
+        // to indices (ascending) and returns how many were written.
+        // indices must hold count entries.
+        size_t filter_greater(const float *data, size_t count, size_t stride,
+                              float threshold, int *indices);
+
+        // YOLOX box decode for the anchors listed in anchors[0..n). feat holds num_attrs
+        // floats per anchor (tx, ty, tw, th, ...), grid_x / grid_y / stride are per anchor.
+        // Writes 4 planes of n floats to boxes: x0, y0, w, h with
+        //   w = exp(tw) * stride, x0 = tx * stride + grid_x - w / 2 (same for y / h)
+        // The vector kernels use a polynomial exp (< 2 ulp from std::exp).
+        void decode_boxes(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                          const float *grid_x, const float *grid_y, const float *stride,
+                          float *boxes);
+
+        // IEEE half precision (bits) -> float, for fp16 output tensors
+        float half_to_f32(uint16_t h);
+        void half_to_f32(const uint16_t *src, float *dst, size_t n);
+
+        // True if box {x0, y0, x1, y1} has IoU > threshold with any of the n boxes
+        // given as corner / area arrays.
+        bool any_iou_greater(const float *x0, const float *y0, const float *x1, const float *y1,
+                             const float *area, size_t n, const float *box, float box_area,
+                             float threshold);
+    }
+}
+#endif
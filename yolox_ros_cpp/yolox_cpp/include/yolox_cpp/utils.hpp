@@ -31,6 +31,30 @@ namespace yolox_cpp
             return class_names;
         }
 
+        // Packed BGR copy of a frame in any PixelFormat.
+        // bgr is reused when it already has the right size.
+        static void to_bgr(const cv::Mat &frame, const PixelFormat format, cv::Mat &bgr)
+        {
+            switch (format)
+            {
+            case PixelFormat::BGR:
+                frame.copyTo(bgr);
+                break;
+            case PixelFormat::RGB:
+                cv::cvtColor(frame, bgr, cv::COLOR_RGB2BGR);
+                break;
+            case PixelFormat::YUYV:
+                cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_YUY2);
+                break;
+            case PixelFormat::UYVY:
+                cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_UYVY);
+                break;
+            case PixelFormat::NV12:
+                cv::cvtColor(frame, bgr, cv::COLOR_YUV2BGR_NV12);
+                break;
+            }
+        }
+
         static void draw_objects(cv::Mat bgr, const std::vector<Object> &objects, const std::vector<std::string> &class_names = COCO_CLASSES)
         {
 
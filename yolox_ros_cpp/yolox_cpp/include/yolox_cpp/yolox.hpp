@@ -3,6 +3,8 @@
 
 #include "config.h"
 
+#include "yolox_null.hpp"
+
 #ifdef ENABLE_OPENVINO
     #include "yolox_openvino.hpp"
 #endif
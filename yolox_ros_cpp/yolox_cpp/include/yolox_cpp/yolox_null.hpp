@@ -0,0 +1,42 @@
+#ifndef _YOLOX_CPP_YOLOX_NULL_HPP
+#define _YOLOX_CPP_YOLOX_NULL_HPP
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "core.hpp"
+#include "coco_names.hpp"
+
+namespace yolox_cpp{
+    // Backend without a model, for measuring everything around inference.
+    // Each call letterboxes the frame as a real backend would, waits latency_ms in
+    // place of the model, then decodes a fixed raw output tensor
+    // (num_anchors x (5 + num_classes) float32):
+    //  - path_to_output set: replayed from that file (e.g. numpy's tofile()),
+    //  - otherwise: synthetic, proposal_density of the anchors carrying an object.
+    class YoloXNull: public AbcYoloX{
+        public:
+            YoloXNull(const file_name_t &path_to_output, int input_w=640, int input_h=640,
+                      double latency_ms=0.0, float proposal_density=0.01,
+                      float nms_th=0.45, float conf_th=0.3, const std::string &model_version="0.1.1rc0",
+                      int num_classes=80, bool p6=false);
+            using AbcYoloX::inference;
+            using AbcYoloX::inference_batch;
+            void inference(const cv::Mat& frame, PixelFormat format, std::vector<Object>& objects) override;
+
+            // Raw output where about proposal_density of the anchors carry a confident object
+            static std::vector<float> synthetic_output(const AnchorTable &anchors,
+                                                       int num_classes, float proposal_density);
+
+        private:
+            void load_output(const file_name_t &path_to_output);
+
+            std::chrono::duration<double, std::milli> latency_;
+            std::vector<float> input_blob_;
+            std::vector<float> output_;
+    };
+}
+
+#endif
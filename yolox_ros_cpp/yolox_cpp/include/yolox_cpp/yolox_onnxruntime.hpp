@@ -20,10 +20,40 @@ namespace yolox_cpp{
                              int intra_op_num_threads, int inter_op_num_threads=1,
                              bool use_cuda=true, int device_id=0, bool use_parallel=false,
                              float nms_th=0.45, float conf_th=0.3, const std::string &model_version="0.1.1rc0",
-                             int num_classes=80, bool p6=false);
-            std::vector<Object> inference(const cv::Mat& frame) override;
+                             int num_classes=80, bool p6=false,
+                             int warmup_runs=0, bool share_allocator=false, bool cpu_mem_arena=true,
+                             const std::string &optimized_model_path="");
+            using AbcYoloX::inference;
+            using AbcYoloX::inference_batch;
+            void inference(const cv::Mat& frame, PixelFormat format, std::vector<Object>& objects) override;
+            std::vector<std::vector<Object>> inference_batch(const std::vector<cv::Mat>& frames, PixelFormat format) override;
+            bool supports_dynamic_input() const override
+            {
+                return this->dynamic_hw_;
+            }
+            bool supports_nms_output() const override
+            {
+                return true;
+            }
 
         private:
+            // input / output buffers and tensors of one dynamic input size
+            struct ShapeBuffers
+            {
+                cv::Size size;
+                std::vector<int64_t> input_shape;
+                std::vector<int64_t> output_shape;
+                std::vector<float> input;
+                std::vector<float> output;
+                Ort::Value input_tensor{nullptr};
+                Ort::Value output_tensor{nullptr};
+                Ort::IoBinding binding{nullptr};
+            };
+
+            void check_nms_output() const override;
+            size_t num_anchors(int input_w, int input_h) const;
+            ShapeBuffers &shape_buffers(const cv::Size &size);
+
             int intra_op_num_threads_ = 1;
             int inter_op_num_threads_ = 1;
             bool use_cuda_ = true;
@@ -31,14 +61,37 @@ namespace yolox_cpp{
             bool use_parallel_ = false;
 
             Ort::Session session_{nullptr};
-            Ort::Env env_{ORT_LOGGING_LEVEL_WARNING, "Default"};
+
+            // created once, reused by every Run()
+            Ort::RunOptions run_options_;
+            Ort::MemoryInfo cpu_memory_info_ = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
 
             Ort::Value input_tensor_{nullptr};
             Ort::Value output_tensor_{nullptr};
+            // input_tensor_ / output_tensor_ bound once, Run() only executes
+            Ort::IoBinding io_binding_{nullptr};
             std::string input_name_;
             std::string output_name_;
             std::vector<std::unique_ptr<uint8_t[]>> input_buffer_;
             std::vector<std::unique_ptr<uint8_t[]>> output_buffer_;
+
+            // batch dimension is dynamic (-1) in the model
+            bool dynamic_batch_ = false;
+            std::vector<int64_t> input_shape_;
+            std::vector<int64_t> output_shape_;
+            size_t input_size_ = 0;
+            size_t output_size_ = 0;
+            std::vector<float> batch_input_;
+            std::vector<float> batch_output_;
+            std::vector<int64_t> batch_input_shape_;
+            std::vector<int64_t> batch_output_shape_;
+
+            // H / W are dynamic (-1) in the model
+            static constexpr int default_input_size_ = 640;
+            bool dynamic_hw_ = false;
+            ONNXTensorElementDataType input_tensor_type_;
+            ONNXTensorElementDataType output_tensor_type_;
+            std::vector<std::unique_ptr<ShapeBuffers>> shape_buffers_;
     };
 }
 
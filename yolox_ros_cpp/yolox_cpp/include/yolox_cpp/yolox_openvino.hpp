@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <iostream>
+#include <exception>
 #include <opencv2/opencv.hpp>
 #include <openvino/openvino.hpp>
 
@@ -17,14 +18,63 @@ namespace yolox_cpp{
         public:
             YoloXOpenVINO(const file_name_t &path_to_model, std::string device_name,
                           float nms_th=0.45, float conf_th=0.3, const std::string &model_version="0.1.1rc0",
-                          int num_classes=80, bool p6=false);
-            std::vector<Object> inference(const cv::Mat& frame) override;
+                          int num_classes=80, bool p6=false, int num_infer_requests=1,
+                          const std::string &cache_dir="", bool embed_preprocess=false);
+            using AbcYoloX::inference;
+            using AbcYoloX::inference_batch;
+            void inference(const cv::Mat& frame, PixelFormat format, std::vector<Object>& objects) override;
+            std::vector<std::vector<Object>> inference_batch(const std::vector<cv::Mat>& frames, PixelFormat format) override;
+            bool supports_dynamic_input() const override
+            {
+                return this->dynamic_hw_;
+            }
+            bool supports_nms_output() const override
+            {
+                return true;
+            }
 
         private:
+            void check_nms_output() const override;
+
+            // input blob of one dynamic input size
+            struct ShapeBlob
+            {
+                cv::Size size;
+                std::vector<float> data;
+                ov::Tensor tensor;
+            };
+
+            std::vector<std::vector<Object>> inference_async(const std::vector<cv::Mat>& frames, PixelFormat format);
+            ov::Tensor &shape_tensor(const cv::Size &size);
+            ov::Tensor make_input_tensor(const ov::Shape &shape, float *data) const;
+            void write_input(const cv::Mat &frame, PixelFormat format, ov::Tensor &tensor);
+            void decode_output(const ov::Tensor &output_tensor, const cv::Size &size,
+                               std::vector<Object> &objects, DecodeScratch *scratch);
+
             std::string device_name_;
+            // 1: synchronous infer(), 0: plugin-optimal pool size, >1: pool size.
+            // The pool serves inference_batch(); single frames always use infer_request_.
+            int num_infer_requests_ = 1;
             std::vector<float> blob_;
+            // f32, or u8 for models whose input takes raw pixels
+            ov::element::Type input_type_ = ov::element::f32;
+            // u8 NHWC input, converted and normalized inside the compiled model
+            bool input_nhwc_ = false;
+            // f32, or f16 for models with an fp16 head
+            ov::element::Type output_type_ = ov::element::f32;
+            ov::PartialShape output_shape_;
+            // wraps blob_, created once
+            ov::Tensor input_tensor_;
+            std::vector<float> batch_blob_;
             ov::Shape input_shape_;
+            bool dynamic_batch_ = false;
+            // H / W are dynamic in the model
+            static constexpr size_t default_input_size_ = 640;
+            bool dynamic_hw_ = false;
+            std::vector<std::unique_ptr<ShapeBlob>> shape_blobs_;
             ov::InferRequest infer_request_;
+            std::vector<ov::InferRequest> async_requests_;
+            std::vector<std::vector<float>> async_blobs_;
     };
 }
 
@@ -37,7 +37,9 @@ namespace yolox_cpp{
                           float nms_th=0.45, float conf_th=0.3, const std::string &model_version="0.1.1rc0",
                           int num_classes=80, bool p6=false);
             ~YoloXTensorRT();
-            std::vector<Object> inference(const cv::Mat& frame) override;
+            using AbcYoloX::inference;
+            using AbcYoloX::inference_batch;
+            void inference(const cv::Mat& frame, PixelFormat format, std::vector<Object>& objects) override;
 
         private:
             void doInference(const float* input, float* output);
@@ -48,9 +50,13 @@ namespace yolox_cpp{
             std::unique_ptr<ICudaEngine> engine_;
             std::unique_ptr<IExecutionContext> context_;
             int output_size_;
+            // kFLOAT, or kHALF for engines with an fp16 output; decoded without conversion
+            bool output_half_ = false;
+            size_t output_element_size_ = sizeof(float);
             const int inputIndex_ = 0;
             const int outputIndex_ = 1;
             void *inference_buffers_[2];
+            cudaStream_t stream_;
             std::vector<float> input_blob_;
             std::vector<float> output_blob_;
 
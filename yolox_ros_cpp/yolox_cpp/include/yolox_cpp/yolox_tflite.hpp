@@ -34,14 +34,29 @@ namespace yolox_cpp{
                         float nms_th=0.45, float conf_th=0.3, const std::string &model_version="0.1.1rc0",
                         int num_classes=80, bool p6=false, bool is_nchw=true);
             ~YoloXTflite();
-            std::vector<Object> inference(const cv::Mat& frame) override;
+            using AbcYoloX::inference;
+            using AbcYoloX::inference_batch;
+            void inference(const cv::Mat& frame, PixelFormat format, std::vector<Object>& objects) override;
+            bool supports_nms_output() const override
+            {
+                return true;
+            }
 
         private:
+            void check_nms_output() const override;
             int doInference(float* input, float* output);
 
+            template <typename T>
+            void write_input(const cv::Mat &frame, PixelFormat format, T *input_blob);
+
             int input_size_;
             int output_size_;
             bool is_nchw_;
+            // element type and quantization of input / output 0 (float, uint8 or int8)
+            TfLiteType input_type_;
+            TfLiteType output_type_;
+            Quantization input_quant_;
+            Quantization output_quant_;
             std::unique_ptr<tflite::FlatBufferModel> model_;
             std::unique_ptr<tflite::ops::builtin::BuiltinOpResolver> resolver_;
             std::unique_ptr<tflite::Interpreter> interpreter_;
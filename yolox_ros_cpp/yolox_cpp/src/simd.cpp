@@ -0,0 +1,950 @@
+#include "yolox_cpp/simd.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+    #define YOLOX_CPP_SIMD_X86
+    #include <immintrin.h>
+    #define YOLOX_CPP_TARGET(isa) __attribute__((target(isa)))
+#elif defined(__aarch64__)
+    #define YOLOX_CPP_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+namespace yolox_cpp
+{
+namespace simd
+{
+namespace
+{
+    using PlanarKernel = void (*)(const uint8_t *, float *, float *, float *, size_t, const float *, const float *);
+    using InterleavedKernel = void (*)(const uint8_t *, float *, size_t, const float *, const float *);
+    using FilterKernel = size_t (*)(const float *, size_t, size_t, float, int *);
+    using IouKernel = bool (*)(const float *, const float *, const float *, const float *,
+                               const float *, size_t, const float *, float, float);
+    using DecodeKernel = void (*)(const float *, size_t, const int *, size_t,
+                                  const float *, const float *, const float *, float *);
+    using HalfKernel = void (*)(const uint16_t *, float *, size_t);
+
+    struct Kernels
+    {
+        const char *name;
+        PlanarKernel planar;
+        InterleavedKernel interleaved;
+        FilterKernel filter;
+        IouKernel any_iou;
+        DecodeKernel decode;
+        HalfKernel half;
+    };
+
+    // expf as in Cephes: exp(x) = 2^n * exp(r), |r| <= ln2 / 2, degree 5 polynomial.
+    // Inputs are clamped so that 2^n stays a normal float.
+    constexpr float exp_max = 88.0f;
+    constexpr float exp_min = -87.0f;
+    constexpr float log2e = 1.44269504088896341f;
+    constexpr float ln2_hi = 0.693359375f;
+    constexpr float ln2_lo = -2.12194440e-4f;
+    constexpr float exp_p0 = 1.9875691500e-4f;
+    constexpr float exp_p1 = 1.3981999507e-3f;
+    constexpr float exp_p2 = 8.3334519073e-3f;
+    constexpr float exp_p3 = 4.1665795894e-2f;
+    constexpr float exp_p4 = 1.6666665459e-1f;
+    constexpr float exp_p5 = 5.0000001201e-1f;
+
+    // ------------------------------------------------------------------
+    // scalar
+    // ------------------------------------------------------------------
+    void bgr_to_planar_f32_scalar(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                                  size_t num_pixels, const float *scale, const float *bias)
+    {
+        for (size_t i = 0; i < num_pixels; ++i)
+        {
+            dst0[i] = static_cast<float>(src[i * 3 + 0]) * scale[0] + bias[0];
+            dst1[i] = static_cast<float>(src[i * 3 + 1]) * scale[1] + bias[1];
+            dst2[i] = static_cast<float>(src[i * 3 + 2]) * scale[2] + bias[2];
+        }
+    }
+
+    void bgr_to_interleaved_f32_scalar(const uint8_t *src, float *dst,
+                                       size_t num_pixels, const float *scale, const float *bias)
+    {
+        for (size_t i = 0; i < num_pixels * 3; i += 3)
+        {
+            dst[i + 0] = static_cast<float>(src[i + 0]) * scale[0] + bias[0];
+            dst[i + 1] = static_cast<float>(src[i + 1]) * scale[1] + bias[1];
+            dst[i + 2] = static_cast<float>(src[i + 2]) * scale[2] + bias[2];
+        }
+    }
+
+    // scans [begin, count), used for the tails of the vector kernels
+    size_t filter_greater_from(const float *data, size_t begin, size_t count, size_t stride,
+                               float threshold, int *indices)
+    {
+        size_t n = 0;
+        for (size_t i = begin; i < count; ++i)
+        {
+            if (data[i * stride] > threshold)
+            {
+                indices[n++] = static_cast<int>(i);
+            }
+        }
+        return n;
+    }
+
+    size_t filter_greater_scalar(const float *data, size_t count, size_t stride,
+                                 float threshold, int *indices)
+    {
+        return filter_greater_from(data, 0, count, stride, threshold, indices);
+    }
+
+    // IoU from box corners; the vector kernels below use the same operation order
+    bool any_iou_greater_from(const float *x0, const float *y0, const float *x1, const float *y1,
+                              const float *area, size_t begin, size_t n, const float *box, float box_area,
+                              float threshold)
+    {
+        for (size_t j = begin; j < n; ++j)
+        {
+            const float iw = std::max(std::min(x1[j], box[2]) - std::max(x0[j], box[0]), 0.0f);
+            const float ih = std::max(std::min(y1[j], box[3]) - std::max(y0[j], box[1]), 0.0f);
+            const float inter = iw * ih;
+            const float uni = box_area + area[j] - inter;
+            if (inter / uni > threshold)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool any_iou_greater_scalar(const float *x0, const float *y0, const float *x1, const float *y1,
+                                const float *area, size_t n, const float *box, float box_area,
+                                float threshold)
+    {
+        return any_iou_greater_from(x0, y0, x1, y1, area, 0, n, box, box_area, threshold);
+    }
+
+    // decodes anchors [begin, n), used for the tails of the vector kernels
+    void decode_boxes_from(const float *feat, size_t num_attrs, const int *anchors, size_t begin, size_t n,
+                           const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        float *x0 = boxes;
+        float *y0 = boxes + n;
+        float *w = boxes + n * 2;
+        float *h = boxes + n * 3;
+        for (size_t i = begin; i < n; ++i)
+        {
+            const int a = anchors[i];
+            const float *reg = feat + static_cast<size_t>(a) * num_attrs;
+            const float s = stride[a];
+            w[i] = std::exp(reg[2]) * s;
+            h[i] = std::exp(reg[3]) * s;
+            x0[i] = reg[0] * s + grid_x[a] - w[i] * 0.5f;
+            y0[i] = reg[1] * s + grid_y[a] - h[i] * 0.5f;
+        }
+    }
+
+    void decode_boxes_scalar(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                             const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        decode_boxes_from(feat, num_attrs, anchors, 0, n, grid_x, grid_y, stride, boxes);
+    }
+
+    // 4 anchors of a vector kernel without gather: tx, ty, tw, th, grid_x, grid_y, stride
+    // as 7 rows of 4
+    void gather_anchors4(const float *feat, size_t num_attrs, const int *anchors,
+                         const float *grid_x, const float *grid_y, const float *stride, float out[7][4])
+    {
+        for (int k = 0; k < 4; ++k)
+        {
+            const int a = anchors[k];
+            const float *reg = feat + static_cast<size_t>(a) * num_attrs;
+            out[0][k] = reg[0];
+            out[1][k] = reg[1];
+            out[2][k] = reg[2];
+            out[3][k] = reg[3];
+            out[4][k] = grid_x[a];
+            out[5][k] = grid_y[a];
+            out[6][k] = stride[a];
+        }
+    }
+
+    float half_bits_to_f32(const uint16_t h)
+    {
+        const uint32_t sign = static_cast<uint32_t>(h & 0x8000u) << 16;
+        const uint32_t exponent = (h >> 10) & 0x1fu;
+        const uint32_t mantissa = h & 0x3ffu;
+        uint32_t bits;
+        if (exponent == 0x1fu)
+        {
+            // inf / nan
+            bits = sign | 0x7f800000u | (mantissa << 13);
+        }
+        else if (exponent != 0)
+        {
+            bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+        }
+        else
+        {
+            // zero / subnormal: mantissa * 2^-24
+            const float f = static_cast<float>(mantissa) * 5.9604644775390625e-8f;
+            return sign ? -f : f;
+        }
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+
+    void half_to_f32_scalar(const uint16_t *src, float *dst, size_t n)
+    {
+        for (size_t i = 0; i < n; ++i)
+        {
+            dst[i] = half_bits_to_f32(src[i]);
+        }
+    }
+
+    // scale / bias repeated so that a vector load at offset j starts with channel j
+    void repeat_bgr(const float *v, float *out, const int n)
+    {
+        for (int i = 0; i < n; ++i)
+        {
+            out[i] = v[i % 3];
+        }
+    }
+
+#ifdef YOLOX_CPP_SIMD_X86
+    // ------------------------------------------------------------------
+    // x86: 16 pixels (48 bytes) per iteration
+    // ------------------------------------------------------------------
+    YOLOX_CPP_TARGET("sse4.1")
+    inline void deinterleave_bgr16(const uint8_t *src, __m128i &c0, __m128i &c1, __m128i &c2)
+    {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 16));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + 32));
+        c0 = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(a, _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13)));
+        c1 = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(a, _mm_setr_epi8(1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14)));
+        c2 = _mm_or_si128(
+            _mm_or_si128(
+                _mm_shuffle_epi8(a, _mm_setr_epi8(2, 5, 8, 11, 14, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1)),
+                _mm_shuffle_epi8(b, _mm_setr_epi8(-1, -1, -1, -1, -1, 1, 4, 7, 10, 13, -1, -1, -1, -1, -1, -1))),
+            _mm_shuffle_epi8(c, _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 3, 6, 9, 12, 15)));
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    inline __m128 u8x4_to_f32_sse41(const __m128i v, const __m128 s, const __m128 b)
+    {
+        return _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(v)), s), b);
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    void bgr_to_planar_f32_sse41(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                                 size_t num_pixels, const float *scale, const float *bias)
+    {
+        float *dst[3] = {dst0, dst1, dst2};
+        __m128 s[3], b[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            s[c] = _mm_set1_ps(scale[c]);
+            b[c] = _mm_set1_ps(bias[c]);
+        }
+        size_t i = 0;
+        for (; i + 16 <= num_pixels; i += 16)
+        {
+            __m128i ch[3];
+            deinterleave_bgr16(src + i * 3, ch[0], ch[1], ch[2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                float *d = dst[c] + i;
+                _mm_storeu_ps(d + 0, u8x4_to_f32_sse41(ch[c], s[c], b[c]));
+                _mm_storeu_ps(d + 4, u8x4_to_f32_sse41(_mm_srli_si128(ch[c], 4), s[c], b[c]));
+                _mm_storeu_ps(d + 8, u8x4_to_f32_sse41(_mm_srli_si128(ch[c], 8), s[c], b[c]));
+                _mm_storeu_ps(d + 12, u8x4_to_f32_sse41(_mm_srli_si128(ch[c], 12), s[c], b[c]));
+            }
+        }
+        bgr_to_planar_f32_scalar(src + i * 3, dst0 + i, dst1 + i, dst2 + i, num_pixels - i, scale, bias);
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    void bgr_to_interleaved_f32_sse41(const uint8_t *src, float *dst,
+                                      size_t num_pixels, const float *scale, const float *bias)
+    {
+        // a vector starting at element e uses pattern e % 3
+        float s_rep[6], b_rep[6];
+        repeat_bgr(scale, s_rep, 6);
+        repeat_bgr(bias, b_rep, 6);
+        __m128 s[3], b[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            s[j] = _mm_loadu_ps(s_rep + j);
+            b[j] = _mm_loadu_ps(b_rep + j);
+        }
+        const size_t n = num_pixels * 3;
+        size_t i = 0;
+        for (; i + 48 <= n; i += 48)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + k * 16));
+                float *d = dst + i + k * 16;
+                _mm_storeu_ps(d + 0, u8x4_to_f32_sse41(v, s[(k * 4 + 0) % 3], b[(k * 4 + 0) % 3]));
+                _mm_storeu_ps(d + 4, u8x4_to_f32_sse41(_mm_srli_si128(v, 4), s[(k * 4 + 1) % 3], b[(k * 4 + 1) % 3]));
+                _mm_storeu_ps(d + 8, u8x4_to_f32_sse41(_mm_srli_si128(v, 8), s[(k * 4 + 2) % 3], b[(k * 4 + 2) % 3]));
+                _mm_storeu_ps(d + 12, u8x4_to_f32_sse41(_mm_srli_si128(v, 12), s[(k * 4 + 3) % 3], b[(k * 4 + 3) % 3]));
+            }
+        }
+        bgr_to_interleaved_f32_scalar(src + i, dst + i, (n - i) / 3, scale, bias);
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    bool any_iou_greater_sse41(const float *x0, const float *y0, const float *x1, const float *y1,
+                               const float *area, size_t n, const float *box, float box_area,
+                               float threshold)
+    {
+        const __m128 bx0 = _mm_set1_ps(box[0]);
+        const __m128 by0 = _mm_set1_ps(box[1]);
+        const __m128 bx1 = _mm_set1_ps(box[2]);
+        const __m128 by1 = _mm_set1_ps(box[3]);
+        const __m128 ba = _mm_set1_ps(box_area);
+        const __m128 th = _mm_set1_ps(threshold);
+        const __m128 zero = _mm_setzero_ps();
+        size_t j = 0;
+        for (; j + 4 <= n; j += 4)
+        {
+            const __m128 iw = _mm_max_ps(_mm_sub_ps(_mm_min_ps(_mm_loadu_ps(x1 + j), bx1), _mm_max_ps(_mm_loadu_ps(x0 + j), bx0)), zero);
+            const __m128 ih = _mm_max_ps(_mm_sub_ps(_mm_min_ps(_mm_loadu_ps(y1 + j), by1), _mm_max_ps(_mm_loadu_ps(y0 + j), by0)), zero);
+            const __m128 inter = _mm_mul_ps(iw, ih);
+            const __m128 uni = _mm_sub_ps(_mm_add_ps(ba, _mm_loadu_ps(area + j)), inter);
+            if (_mm_movemask_ps(_mm_cmpgt_ps(_mm_div_ps(inter, uni), th)))
+            {
+                return true;
+            }
+        }
+        return any_iou_greater_from(x0, y0, x1, y1, area, j, n, box, box_area, threshold);
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    inline __m128 exp_sse41(__m128 x)
+    {
+        x = _mm_min_ps(_mm_max_ps(x, _mm_set1_ps(exp_min)), _mm_set1_ps(exp_max));
+        const __m128 n = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(ln2_hi)));
+        r = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(ln2_lo)));
+        __m128 p = _mm_set1_ps(exp_p0);
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(exp_p1));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(exp_p2));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(exp_p3));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(exp_p4));
+        p = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(exp_p5));
+        p = _mm_add_ps(_mm_mul_ps(p, _mm_mul_ps(r, r)), _mm_add_ps(r, _mm_set1_ps(1.0f)));
+        const __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23);
+        return _mm_mul_ps(p, _mm_castsi128_ps(e));
+    }
+
+    YOLOX_CPP_TARGET("sse4.1")
+    void decode_boxes_sse41(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                            const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        const __m128 half = _mm_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            float v[7][4];
+            gather_anchors4(feat, num_attrs, anchors + i, grid_x, grid_y, stride, v);
+            const __m128 s = _mm_loadu_ps(v[6]);
+            const __m128 w = _mm_mul_ps(exp_sse41(_mm_loadu_ps(v[2])), s);
+            const __m128 h = _mm_mul_ps(exp_sse41(_mm_loadu_ps(v[3])), s);
+            const __m128 x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(v[0]), s), _mm_loadu_ps(v[4]));
+            const __m128 y = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(v[1]), s), _mm_loadu_ps(v[5]));
+            _mm_storeu_ps(boxes + i, _mm_sub_ps(x, _mm_mul_ps(w, half)));
+            _mm_storeu_ps(boxes + n + i, _mm_sub_ps(y, _mm_mul_ps(h, half)));
+            _mm_storeu_ps(boxes + n * 2 + i, w);
+            _mm_storeu_ps(boxes + n * 3 + i, h);
+        }
+        decode_boxes_from(feat, num_attrs, anchors, i, n, grid_x, grid_y, stride, boxes);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    inline __m256 u8x8_to_f32_avx2(const __m128i v, const __m256 s, const __m256 b)
+    {
+        return _mm256_fmadd_ps(_mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v)), s, b);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    void bgr_to_planar_f32_avx2(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                                size_t num_pixels, const float *scale, const float *bias)
+    {
+        float *dst[3] = {dst0, dst1, dst2};
+        __m256 s[3], b[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            s[c] = _mm256_set1_ps(scale[c]);
+            b[c] = _mm256_set1_ps(bias[c]);
+        }
+        size_t i = 0;
+        for (; i + 16 <= num_pixels; i += 16)
+        {
+            __m128i ch[3];
+            deinterleave_bgr16(src + i * 3, ch[0], ch[1], ch[2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                float *d = dst[c] + i;
+                _mm256_storeu_ps(d + 0, u8x8_to_f32_avx2(ch[c], s[c], b[c]));
+                _mm256_storeu_ps(d + 8, u8x8_to_f32_avx2(_mm_srli_si128(ch[c], 8), s[c], b[c]));
+            }
+        }
+        bgr_to_planar_f32_scalar(src + i * 3, dst0 + i, dst1 + i, dst2 + i, num_pixels - i, scale, bias);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    void bgr_to_interleaved_f32_avx2(const uint8_t *src, float *dst,
+                                     size_t num_pixels, const float *scale, const float *bias)
+    {
+        // a vector starting at element e uses pattern e % 3
+        float s_rep[10], b_rep[10];
+        repeat_bgr(scale, s_rep, 10);
+        repeat_bgr(bias, b_rep, 10);
+        __m256 s[3], b[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            s[j] = _mm256_loadu_ps(s_rep + j);
+            b[j] = _mm256_loadu_ps(b_rep + j);
+        }
+        const size_t n = num_pixels * 3;
+        size_t i = 0;
+        for (; i + 48 <= n; i += 48)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + k * 16));
+                float *d = dst + i + k * 16;
+                _mm256_storeu_ps(d + 0, u8x8_to_f32_avx2(v, s[(k * 4 + 0) % 3], b[(k * 4 + 0) % 3]));
+                _mm256_storeu_ps(d + 8, u8x8_to_f32_avx2(_mm_srli_si128(v, 8), s[(k * 4 + 2) % 3], b[(k * 4 + 2) % 3]));
+            }
+        }
+        bgr_to_interleaved_f32_scalar(src + i, dst + i, (n - i) / 3, scale, bias);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    size_t filter_greater_avx2(const float *data, size_t count, size_t stride,
+                               float threshold, int *indices)
+    {
+        const int s = static_cast<int>(stride);
+        const __m256i offsets = _mm256_setr_epi32(0, s, 2 * s, 3 * s, 4 * s, 5 * s, 6 * s, 7 * s);
+        const __m256 th = _mm256_set1_ps(threshold);
+        size_t n = 0;
+        size_t i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 v = _mm256_i32gather_ps(data + i * stride, offsets, 4);
+            unsigned mask = static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(v, th, _CMP_GT_OQ)));
+            while (mask)
+            {
+                indices[n++] = static_cast<int>(i) + __builtin_ctz(mask);
+                mask &= mask - 1;
+            }
+        }
+        return n + filter_greater_from(data, i, count, stride, threshold, indices + n);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    bool any_iou_greater_avx2(const float *x0, const float *y0, const float *x1, const float *y1,
+                              const float *area, size_t n, const float *box, float box_area,
+                              float threshold)
+    {
+        const __m256 bx0 = _mm256_set1_ps(box[0]);
+        const __m256 by0 = _mm256_set1_ps(box[1]);
+        const __m256 bx1 = _mm256_set1_ps(box[2]);
+        const __m256 by1 = _mm256_set1_ps(box[3]);
+        const __m256 ba = _mm256_set1_ps(box_area);
+        const __m256 th = _mm256_set1_ps(threshold);
+        const __m256 zero = _mm256_setzero_ps();
+        size_t j = 0;
+        for (; j + 8 <= n; j += 8)
+        {
+            const __m256 iw = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(x1 + j), bx1), _mm256_max_ps(_mm256_loadu_ps(x0 + j), bx0)), zero);
+            const __m256 ih = _mm256_max_ps(_mm256_sub_ps(_mm256_min_ps(_mm256_loadu_ps(y1 + j), by1), _mm256_max_ps(_mm256_loadu_ps(y0 + j), by0)), zero);
+            const __m256 inter = _mm256_mul_ps(iw, ih);
+            const __m256 uni = _mm256_sub_ps(_mm256_add_ps(ba, _mm256_loadu_ps(area + j)), inter);
+            if (_mm256_movemask_ps(_mm256_cmp_ps(_mm256_div_ps(inter, uni), th, _CMP_GT_OQ)))
+            {
+                return true;
+            }
+        }
+        return any_iou_greater_from(x0, y0, x1, y1, area, j, n, box, box_area, threshold);
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    inline __m256 exp_avx2(__m256 x)
+    {
+        x = _mm256_min_ps(_mm256_max_ps(x, _mm256_set1_ps(exp_min)), _mm256_set1_ps(exp_max));
+        const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ln2_hi), x);
+        r = _mm256_fnmadd_ps(n, _mm256_set1_ps(ln2_lo), r);
+        __m256 p = _mm256_set1_ps(exp_p0);
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_p1));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_p2));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_p3));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_p4));
+        p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(exp_p5));
+        p = _mm256_fmadd_ps(p, _mm256_mul_ps(r, r), _mm256_add_ps(r, _mm256_set1_ps(1.0f)));
+        const __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        return _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+    }
+
+    YOLOX_CPP_TARGET("avx2,fma")
+    void decode_boxes_avx2(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                           const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        const __m256i attrs = _mm256_set1_epi32(static_cast<int>(num_attrs));
+        const __m256 half = _mm256_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(anchors + i));
+            const __m256i pos = _mm256_mullo_epi32(a, attrs);
+            const __m256 s = _mm256_i32gather_ps(stride, a, 4);
+            const __m256 w = _mm256_mul_ps(exp_avx2(_mm256_i32gather_ps(feat + 2, pos, 4)), s);
+            const __m256 h = _mm256_mul_ps(exp_avx2(_mm256_i32gather_ps(feat + 3, pos, 4)), s);
+            const __m256 x = _mm256_fmadd_ps(_mm256_i32gather_ps(feat + 0, pos, 4), s, _mm256_i32gather_ps(grid_x, a, 4));
+            const __m256 y = _mm256_fmadd_ps(_mm256_i32gather_ps(feat + 1, pos, 4), s, _mm256_i32gather_ps(grid_y, a, 4));
+            _mm256_storeu_ps(boxes + i, _mm256_fnmadd_ps(w, half, x));
+            _mm256_storeu_ps(boxes + n + i, _mm256_fnmadd_ps(h, half, y));
+            _mm256_storeu_ps(boxes + n * 2 + i, w);
+            _mm256_storeu_ps(boxes + n * 3 + i, h);
+        }
+        decode_boxes_from(feat, num_attrs, anchors, i, n, grid_x, grid_y, stride, boxes);
+    }
+
+    // F16C comes with every AVX2 CPU, but is checked separately
+    YOLOX_CPP_TARGET("avx,f16c")
+    void half_to_f32_f16c(const uint16_t *src, float *dst, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 8 <= n; i += 8)
+        {
+            _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+        }
+        half_to_f32_scalar(src + i, dst + i, n - i);
+    }
+
+    // GCC 12 warns about _mm512_undefined_* inside its own AVX-512 intrinsics
+    // (GCC bug 105593), only for the kernels below
+#if !defined(__clang__)
+    #pragma GCC diagnostic push
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+    YOLOX_CPP_TARGET("avx512f")
+    inline __m512 u8x16_to_f32_avx512(const __m128i v, const __m512 s, const __m512 b)
+    {
+        return _mm512_fmadd_ps(_mm512_cvtepi32_ps(_mm512_cvtepu8_epi32(v)), s, b);
+    }
+
+    YOLOX_CPP_TARGET("avx512f")
+    void bgr_to_planar_f32_avx512(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                                  size_t num_pixels, const float *scale, const float *bias)
+    {
+        float *dst[3] = {dst0, dst1, dst2};
+        __m512 s[3], b[3];
+        for (int c = 0; c < 3; ++c)
+        {
+            s[c] = _mm512_set1_ps(scale[c]);
+            b[c] = _mm512_set1_ps(bias[c]);
+        }
+        size_t i = 0;
+        for (; i + 16 <= num_pixels; i += 16)
+        {
+            __m128i ch[3];
+            deinterleave_bgr16(src + i * 3, ch[0], ch[1], ch[2]);
+            for (int c = 0; c < 3; ++c)
+            {
+                _mm512_storeu_ps(dst[c] + i, u8x16_to_f32_avx512(ch[c], s[c], b[c]));
+            }
+        }
+        bgr_to_planar_f32_scalar(src + i * 3, dst0 + i, dst1 + i, dst2 + i, num_pixels - i, scale, bias);
+    }
+
+    YOLOX_CPP_TARGET("avx512f")
+    void bgr_to_interleaved_f32_avx512(const uint8_t *src, float *dst,
+                                       size_t num_pixels, const float *scale, const float *bias)
+    {
+        // a vector starting at element e uses pattern e % 3
+        float s_rep[18], b_rep[18];
+        repeat_bgr(scale, s_rep, 18);
+        repeat_bgr(bias, b_rep, 18);
+        __m512 s[3], b[3];
+        for (int j = 0; j < 3; ++j)
+        {
+            s[j] = _mm512_loadu_ps(s_rep + j);
+            b[j] = _mm512_loadu_ps(b_rep + j);
+        }
+        const size_t n = num_pixels * 3;
+        size_t i = 0;
+        for (; i + 48 <= n; i += 48)
+        {
+            for (int k = 0; k < 3; ++k)
+            {
+                const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i + k * 16));
+                _mm512_storeu_ps(dst + i + k * 16, u8x16_to_f32_avx512(v, s[k], b[k]));
+            }
+        }
+        bgr_to_interleaved_f32_scalar(src + i, dst + i, (n - i) / 3, scale, bias);
+    }
+    YOLOX_CPP_TARGET("avx512f")
+    size_t filter_greater_avx512(const float *data, size_t count, size_t stride,
+                                 float threshold, int *indices)
+    {
+        const __m512i lanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+        const __m512i offsets = _mm512_mullo_epi32(lanes, _mm512_set1_epi32(static_cast<int>(stride)));
+        const __m512 th = _mm512_set1_ps(threshold);
+        size_t n = 0;
+        size_t i = 0;
+        for (; i + 16 <= count; i += 16)
+        {
+            const __m512 v = _mm512_i32gather_ps(offsets, data + i * stride, 4);
+            const __mmask16 mask = _mm512_cmp_ps_mask(v, th, _CMP_GT_OQ);
+            if (mask)
+            {
+                const __m512i idx = _mm512_add_epi32(lanes, _mm512_set1_epi32(static_cast<int>(i)));
+                _mm512_mask_compressstoreu_epi32(indices + n, mask, idx);
+                n += __builtin_popcount(mask);
+            }
+        }
+        return n + filter_greater_from(data, i, count, stride, threshold, indices + n);
+    }
+
+    YOLOX_CPP_TARGET("avx512f")
+    bool any_iou_greater_avx512(const float *x0, const float *y0, const float *x1, const float *y1,
+                                const float *area, size_t n, const float *box, float box_area,
+                                float threshold)
+    {
+        const __m512 bx0 = _mm512_set1_ps(box[0]);
+        const __m512 by0 = _mm512_set1_ps(box[1]);
+        const __m512 bx1 = _mm512_set1_ps(box[2]);
+        const __m512 by1 = _mm512_set1_ps(box[3]);
+        const __m512 ba = _mm512_set1_ps(box_area);
+        const __m512 th = _mm512_set1_ps(threshold);
+        const __m512 zero = _mm512_setzero_ps();
+        size_t j = 0;
+        for (; j + 16 <= n; j += 16)
+        {
+            const __m512 iw = _mm512_max_ps(_mm512_sub_ps(_mm512_min_ps(_mm512_loadu_ps(x1 + j), bx1), _mm512_max_ps(_mm512_loadu_ps(x0 + j), bx0)), zero);
+            const __m512 ih = _mm512_max_ps(_mm512_sub_ps(_mm512_min_ps(_mm512_loadu_ps(y1 + j), by1), _mm512_max_ps(_mm512_loadu_ps(y0 + j), by0)), zero);
+            const __m512 inter = _mm512_mul_ps(iw, ih);
+            const __m512 uni = _mm512_sub_ps(_mm512_add_ps(ba, _mm512_loadu_ps(area + j)), inter);
+            if (_mm512_cmp_ps_mask(_mm512_div_ps(inter, uni), th, _CMP_GT_OQ))
+            {
+                return true;
+            }
+        }
+        return any_iou_greater_from(x0, y0, x1, y1, area, j, n, box, box_area, threshold);
+    }
+
+    YOLOX_CPP_TARGET("avx512f")
+    inline __m512 exp_avx512(__m512 x)
+    {
+        x = _mm512_min_ps(_mm512_max_ps(x, _mm512_set1_ps(exp_min)), _mm512_set1_ps(exp_max));
+        const __m512 n = _mm512_roundscale_ps(_mm512_mul_ps(x, _mm512_set1_ps(log2e)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ln2_hi), x);
+        r = _mm512_fnmadd_ps(n, _mm512_set1_ps(ln2_lo), r);
+        __m512 p = _mm512_set1_ps(exp_p0);
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_p1));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_p2));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_p3));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_p4));
+        p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(exp_p5));
+        p = _mm512_fmadd_ps(p, _mm512_mul_ps(r, r), _mm512_add_ps(r, _mm512_set1_ps(1.0f)));
+        const __m512i e = _mm512_slli_epi32(_mm512_add_epi32(_mm512_cvtps_epi32(n), _mm512_set1_epi32(127)), 23);
+        return _mm512_mul_ps(p, _mm512_castsi512_ps(e));
+    }
+
+    YOLOX_CPP_TARGET("avx512f")
+    void decode_boxes_avx512(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                             const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        const __m512i attrs = _mm512_set1_epi32(static_cast<int>(num_attrs));
+        const __m512 half = _mm512_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m512i a = _mm512_loadu_si512(anchors + i);
+            const __m512i pos = _mm512_mullo_epi32(a, attrs);
+            const __m512 s = _mm512_i32gather_ps(a, stride, 4);
+            const __m512 w = _mm512_mul_ps(exp_avx512(_mm512_i32gather_ps(pos, feat + 2, 4)), s);
+            const __m512 h = _mm512_mul_ps(exp_avx512(_mm512_i32gather_ps(pos, feat + 3, 4)), s);
+            const __m512 x = _mm512_fmadd_ps(_mm512_i32gather_ps(pos, feat + 0, 4), s, _mm512_i32gather_ps(a, grid_x, 4));
+            const __m512 y = _mm512_fmadd_ps(_mm512_i32gather_ps(pos, feat + 1, 4), s, _mm512_i32gather_ps(a, grid_y, 4));
+            _mm512_storeu_ps(boxes + i, _mm512_fnmadd_ps(w, half, x));
+            _mm512_storeu_ps(boxes + n + i, _mm512_fnmadd_ps(h, half, y));
+            _mm512_storeu_ps(boxes + n * 2 + i, w);
+            _mm512_storeu_ps(boxes + n * 3 + i, h);
+        }
+        decode_boxes_from(feat, num_attrs, anchors, i, n, grid_x, grid_y, stride, boxes);
+    }
+#if !defined(__clang__)
+    #pragma GCC diagnostic pop
+#endif
+#endif // YOLOX_CPP_SIMD_X86
+
+#ifdef YOLOX_CPP_SIMD_NEON
+    // ------------------------------------------------------------------
+    // aarch64 NEON: 16 pixels per iteration
+    // ------------------------------------------------------------------
+    inline void u8x16_to_f32_neon(const uint8x16_t v, const float32x4_t s, const float32x4_t b, float32x4_t out[4])
+    {
+        const uint16x8_t lo = vmovl_u8(vget_low_u8(v));
+        const uint16x8_t hi = vmovl_u8(vget_high_u8(v));
+        out[0] = vfmaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_low_u16(lo))), s);
+        out[1] = vfmaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_high_u16(lo))), s);
+        out[2] = vfmaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_low_u16(hi))), s);
+        out[3] = vfmaq_f32(b, vcvtq_f32_u32(vmovl_u16(vget_high_u16(hi))), s);
+    }
+
+    void bgr_to_planar_f32_neon(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                                size_t num_pixels, const float *scale, const float *bias)
+    {
+        float *dst[3] = {dst0, dst1, dst2};
+        size_t i = 0;
+        for (; i + 16 <= num_pixels; i += 16)
+        {
+            const uint8x16x3_t px = vld3q_u8(src + i * 3);
+            for (int c = 0; c < 3; ++c)
+            {
+                float32x4_t f[4];
+                u8x16_to_f32_neon(px.val[c], vdupq_n_f32(scale[c]), vdupq_n_f32(bias[c]), f);
+                for (int q = 0; q < 4; ++q)
+                {
+                    vst1q_f32(dst[c] + i + q * 4, f[q]);
+                }
+            }
+        }
+        bgr_to_planar_f32_scalar(src + i * 3, dst0 + i, dst1 + i, dst2 + i, num_pixels - i, scale, bias);
+    }
+
+    void bgr_to_interleaved_f32_neon(const uint8_t *src, float *dst,
+                                     size_t num_pixels, const float *scale, const float *bias)
+    {
+        size_t i = 0;
+        for (; i + 16 <= num_pixels; i += 16)
+        {
+            const uint8x16x3_t px = vld3q_u8(src + i * 3);
+            float32x4_t f[3][4];
+            for (int c = 0; c < 3; ++c)
+            {
+                u8x16_to_f32_neon(px.val[c], vdupq_n_f32(scale[c]), vdupq_n_f32(bias[c]), f[c]);
+            }
+            for (int q = 0; q < 4; ++q)
+            {
+                float32x4x3_t out;
+                out.val[0] = f[0][q];
+                out.val[1] = f[1][q];
+                out.val[2] = f[2][q];
+                vst3q_f32(dst + (i + q * 4) * 3, out);
+            }
+        }
+        bgr_to_interleaved_f32_scalar(src + i * 3, dst + i * 3, num_pixels - i, scale, bias);
+    }
+
+    bool any_iou_greater_neon(const float *x0, const float *y0, const float *x1, const float *y1,
+                              const float *area, size_t n, const float *box, float box_area,
+                              float threshold)
+    {
+        const float32x4_t bx0 = vdupq_n_f32(box[0]);
+        const float32x4_t by0 = vdupq_n_f32(box[1]);
+        const float32x4_t bx1 = vdupq_n_f32(box[2]);
+        const float32x4_t by1 = vdupq_n_f32(box[3]);
+        const float32x4_t ba = vdupq_n_f32(box_area);
+        const float32x4_t th = vdupq_n_f32(threshold);
+        const float32x4_t zero = vdupq_n_f32(0.0f);
+        size_t j = 0;
+        for (; j + 4 <= n; j += 4)
+        {
+            const float32x4_t iw = vmaxq_f32(vsubq_f32(vminq_f32(vld1q_f32(x1 + j), bx1), vmaxq_f32(vld1q_f32(x0 + j), bx0)), zero);
+            const float32x4_t ih = vmaxq_f32(vsubq_f32(vminq_f32(vld1q_f32(y1 + j), by1), vmaxq_f32(vld1q_f32(y0 + j), by0)), zero);
+            const float32x4_t inter = vmulq_f32(iw, ih);
+            const float32x4_t uni = vsubq_f32(vaddq_f32(ba, vld1q_f32(area + j)), inter);
+            if (vmaxvq_u32(vcgtq_f32(vdivq_f32(inter, uni), th)))
+            {
+                return true;
+            }
+        }
+        return any_iou_greater_from(x0, y0, x1, y1, area, j, n, box, box_area, threshold);
+    }
+
+    inline float32x4_t exp_neon(float32x4_t x)
+    {
+        x = vminq_f32(vmaxq_f32(x, vdupq_n_f32(exp_min)), vdupq_n_f32(exp_max));
+        const float32x4_t n = vrndnq_f32(vmulq_f32(x, vdupq_n_f32(log2e)));
+        float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(ln2_hi));
+        r = vfmsq_f32(r, n, vdupq_n_f32(ln2_lo));
+        float32x4_t p = vdupq_n_f32(exp_p0);
+        p = vfmaq_f32(vdupq_n_f32(exp_p1), p, r);
+        p = vfmaq_f32(vdupq_n_f32(exp_p2), p, r);
+        p = vfmaq_f32(vdupq_n_f32(exp_p3), p, r);
+        p = vfmaq_f32(vdupq_n_f32(exp_p4), p, r);
+        p = vfmaq_f32(vdupq_n_f32(exp_p5), p, r);
+        p = vfmaq_f32(vaddq_f32(r, vdupq_n_f32(1.0f)), p, vmulq_f32(r, r));
+        const int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+        return vmulq_f32(p, vreinterpretq_f32_s32(e));
+    }
+
+    void decode_boxes_neon(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                           const float *grid_x, const float *grid_y, const float *stride, float *boxes)
+    {
+        const float32x4_t half = vdupq_n_f32(0.5f);
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            float v[7][4];
+            gather_anchors4(feat, num_attrs, anchors + i, grid_x, grid_y, stride, v);
+            const float32x4_t s = vld1q_f32(v[6]);
+            const float32x4_t w = vmulq_f32(exp_neon(vld1q_f32(v[2])), s);
+            const float32x4_t h = vmulq_f32(exp_neon(vld1q_f32(v[3])), s);
+            const float32x4_t x = vfmaq_f32(vld1q_f32(v[4]), vld1q_f32(v[0]), s);
+            const float32x4_t y = vfmaq_f32(vld1q_f32(v[5]), vld1q_f32(v[1]), s);
+            vst1q_f32(boxes + i, vfmsq_f32(x, w, half));
+            vst1q_f32(boxes + n + i, vfmsq_f32(y, h, half));
+            vst1q_f32(boxes + n * 2 + i, w);
+            vst1q_f32(boxes + n * 3 + i, h);
+        }
+        decode_boxes_from(feat, num_attrs, anchors, i, n, grid_x, grid_y, stride, boxes);
+    }
+
+    void half_to_f32_neon(const uint16_t *src, float *dst, size_t n)
+    {
+        size_t i = 0;
+        for (; i + 4 <= n; i += 4)
+        {
+            vst1q_f32(dst + i, vcvt_f32_f16(vreinterpret_f16_u16(vld1_u16(src + i))));
+        }
+        half_to_f32_scalar(src + i, dst + i, n - i);
+    }
+#endif // YOLOX_CPP_SIMD_NEON
+
+    // every kernel set the host supports, best first
+    std::vector<Kernels> supported_kernels()
+    {
+        std::vector<Kernels> sets;
+#if defined(YOLOX_CPP_SIMD_X86)
+        __builtin_cpu_init();
+        const HalfKernel half = __builtin_cpu_supports("f16c") ? half_to_f32_f16c : half_to_f32_scalar;
+        if (__builtin_cpu_supports("avx512f"))
+        {
+            sets.push_back({"avx512", bgr_to_planar_f32_avx512, bgr_to_interleaved_f32_avx512, filter_greater_avx512, any_iou_greater_avx512, decode_boxes_avx512, half});
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+        {
+            sets.push_back({"avx2", bgr_to_planar_f32_avx2, bgr_to_interleaved_f32_avx2, filter_greater_avx2, any_iou_greater_avx2, decode_boxes_avx2, half});
+        }
+        if (__builtin_cpu_supports("sse4.1"))
+        {
+            // no gather before AVX2, the strided scan stays scalar
+            sets.push_back({"sse4.1", bgr_to_planar_f32_sse41, bgr_to_interleaved_f32_sse41, filter_greater_scalar, any_iou_greater_sse41, decode_boxes_sse41, half});
+        }
+#elif defined(YOLOX_CPP_SIMD_NEON)
+        sets.push_back({"neon", bgr_to_planar_f32_neon, bgr_to_interleaved_f32_neon, filter_greater_scalar, any_iou_greater_neon, decode_boxes_neon, half_to_f32_neon});
+#endif
+        sets.push_back({"scalar", bgr_to_planar_f32_scalar, bgr_to_interleaved_f32_scalar, filter_greater_scalar, any_iou_greater_scalar, decode_boxes_scalar, half_to_f32_scalar});
+        return sets;
+    }
+
+    const std::vector<Kernels> &all_kernels()
+    {
+        static const std::vector<Kernels> sets = supported_kernels();
+        return sets;
+    }
+
+    // the best set unless set_isa() picked another one
+    std::atomic<const Kernels *> &selected_kernels()
+    {
+        static std::atomic<const Kernels *> selected{&all_kernels().front()};
+        return selected;
+    }
+
+    const Kernels &kernels()
+    {
+        return *selected_kernels().load(std::memory_order_relaxed);
+    }
+} // namespace
+
+    const char *active_isa()
+    {
+        return kernels().name;
+    }
+
+    std::vector<std::string> available_isas()
+    {
+        std::vector<std::string> names;
+        for (const Kernels &set : all_kernels())
+        {
+            names.emplace_back(set.name);
+        }
+        return names;
+    }
+
+    bool set_isa(const std::string &name)
+    {
+        for (const Kernels &set : all_kernels())
+        {
+            if (name == set.name)
+            {
+                selected_kernels().store(&set, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void bgr_to_planar_f32(const uint8_t *src, float *dst0, float *dst1, float *dst2,
+                           size_t num_pixels, const float *scale, const float *bias)
+    {
+        kernels().planar(src, dst0, dst1, dst2, num_pixels, scale, bias);
+    }
+
+    void bgr_to_interleaved_f32(const uint8_t *src, float *dst,
+                                size_t num_pixels, const float *scale, const float *bias)
+    {
+        kernels().interleaved(src, dst, num_pixels, scale, bias);
+    }
+
+    size_t filter_greater(const float *data, size_t count, size_t stride,
+                          float threshold, int *indices)
+    {
+        return kernels().filter(data, count, stride, threshold, indices);
+    }
+
+    bool any_iou_greater(const float *x0, const float *y0, const float *x1, const float *y1,
+                         const float *area, size_t n, const float *box, float box_area,
+                         float threshold)
+    {
+        return kernels().any_iou(x0, y0, x1, y1, area, n, box, box_area, threshold);
+    }
+
+    void decode_boxes(const float *feat, size_t num_attrs, const int *anchors, size_t n,
+                      const float *grid_x, const float *grid_y, const float *stride,
+                      float *boxes)
+    {
+        kernels().decode(feat, num_attrs, anchors, n, grid_x, grid_y, stride, boxes);
+    }
+
+    float half_to_f32(uint16_t h)
+    {
+        return half_bits_to_f32(h);
+    }
+
+    void half_to_f32(const uint16_t *src, float *dst, size_t n)
+    {
+        kernels().half(src, dst, n);
+    }
+} // namespace simd
+} // namespace yolox_cpp
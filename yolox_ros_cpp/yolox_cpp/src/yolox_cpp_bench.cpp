@@ -0,0 +1,476 @@
+// Offline benchmark for the yolox_cpp backends (no ROS runtime needed).
+//
+//   yolox_cpp_bench --model_type onnxruntime --model_path yolox_tiny.onnx
+//                   [--images DIR] [--iterations 200] [--output result.json]
+//
+// Runs warmup + timed iterations over the images of a directory (or synthetic
+// frames) and prints throughput, latency percentiles and the per-stage
+// breakdown as JSON.
+//
+// Heap allocations made inside the timed inference calls are counted as well;
+// --max_allocations_per_frame N makes the run fail when that count is exceeded.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <opencv2/opencv.hpp>
+
+#include "yolox_cpp/core.hpp"
+#include "yolox_cpp/yolox.hpp"
+
+namespace
+{
+    // incremented by the replaced global operator new below
+    std::atomic<uint64_t> allocation_count{0};
+}
+
+void *operator new(std::size_t size)
+{
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    if (void *ptr = std::malloc(size == 0 ? 1 : size))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
+
+namespace
+{
+    using Options = std::map<std::string, std::string>;
+
+    const Options default_options = {
+        {"model_type", ""},
+        {"model_path", ""},
+        {"model_version", "0.1.1rc0"},
+        {"num_classes", "80"},
+        {"p6", "false"},
+        {"conf", "0.3"},
+        {"nms", "0.45"},
+        {"output_format", "raw"},
+        {"nms_method", "reference"},
+        {"nms_class_agnostic", "true"},
+        {"nms_max_proposals", "0"},
+        {"dynamic_input_width", "0"},
+        {"dynamic_input_height", "0"},
+        {"tiling", "false"},
+        {"tile_width", "0"},
+        {"tile_height", "0"},
+        {"tile_overlap", "0.2"},
+        {"tile_global_view", "true"},
+        {"images", ""},
+        {"width", "1280"},
+        {"height", "720"},
+        {"num_frames", "16"},
+        {"seed", "0"},
+        {"warmup", "10"},
+        {"iterations", "100"},
+        {"batch", "1"},
+        {"output", ""},
+        {"max_allocations_per_frame", "-1"},
+        // backend settings
+        {"openvino_device", "CPU"},
+        {"openvino_num_infer_requests", "1"},
+        {"openvino_cache_dir", ""},
+        {"openvino_embed_preprocess", "false"},
+        {"tensorrt_device", "0"},
+        {"onnxruntime_intra_op_num_threads", "1"},
+        {"onnxruntime_inter_op_num_threads", "1"},
+        {"onnxruntime_use_cuda", "false"},
+        {"onnxruntime_device_id", "0"},
+        {"onnxruntime_use_parallel", "false"},
+        {"onnxruntime_warmup_runs", "1"},
+        {"onnxruntime_cpu_mem_arena", "true"},
+        {"onnxruntime_share_allocator", "false"},
+        {"onnxruntime_optimized_model_path", ""},
+        {"tflite_num_threads", "1"},
+        {"is_nchw", "true"},
+        {"null_output_path", ""},
+        {"null_input_width", "640"},
+        {"null_input_height", "640"},
+        {"null_latency_ms", "0.0"},
+        {"null_proposal_density", "0.01"},
+    };
+
+    void print_usage()
+    {
+        std::cerr << "usage: yolox_cpp_bench --model_type TYPE --model_path PATH [--key value ...]" << std::endl;
+        std::cerr << "options (default):" << std::endl;
+        for (const auto &kv : default_options)
+        {
+            std::cerr << "  --" << kv.first << " (" << kv.second << ")" << std::endl;
+        }
+    }
+
+    bool parse_args(int argc, char **argv, Options &options)
+    {
+        options = default_options;
+        for (int i = 1; i < argc; i += 2)
+        {
+            const std::string key = argv[i];
+            if (key.rfind("--", 0) != 0 || i + 1 >= argc || options.count(key.substr(2)) == 0)
+            {
+                std::cerr << "invalid argument: " << key << std::endl;
+                return false;
+            }
+            options[key.substr(2)] = argv[i + 1];
+        }
+        return !options["model_type"].empty() && (!options["model_path"].empty() || options["model_type"] == "null");
+    }
+
+    bool to_bool(const std::string &value)
+    {
+        return value == "true" || value == "1" || value == "on";
+    }
+
+    // string value as a JSON string literal, quotes included
+    std::string json_string(const std::string &value)
+    {
+        std::ostringstream ss;
+        ss << "\"";
+        for (const char c : value)
+        {
+            switch (c)
+            {
+            case '"':
+                ss << "\\\"";
+                break;
+            case '\\':
+                ss << "\\\\";
+                break;
+            case '\n':
+                ss << "\\n";
+                break;
+            case '\r':
+                ss << "\\r";
+                break;
+            case '\t':
+                ss << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    // other control characters as a 4-digit escape
+                    const char *hex = "0123456789abcdef";
+                    ss << "\\u00" << hex[(c >> 4) & 0xf] << hex[c & 0xf];
+                }
+                else
+                {
+                    ss << c;
+                }
+                break;
+            }
+        }
+        ss << "\"";
+        return ss.str();
+    }
+
+    std::unique_ptr<yolox_cpp::AbcYoloX> create_backend(Options &o)
+    {
+        const std::string &type = o["model_type"];
+        const float nms = std::stof(o["nms"]);
+        const float conf = std::stof(o["conf"]);
+        const int num_classes = std::stoi(o["num_classes"]);
+        const bool p6 = to_bool(o["p6"]);
+        if (type == "openvino")
+        {
+#ifdef ENABLE_OPENVINO
+            return std::make_unique<yolox_cpp::YoloXOpenVINO>(
+                o["model_path"], o["openvino_device"], nms, conf, o["model_version"], num_classes, p6,
+                std::stoi(o["openvino_num_infer_requests"]),
+                o["openvino_cache_dir"], to_bool(o["openvino_embed_preprocess"]));
+#endif
+        }
+        else if (type == "tensorrt")
+        {
+#ifdef ENABLE_TENSORRT
+            return std::make_unique<yolox_cpp::YoloXTensorRT>(
+                o["model_path"], std::stoi(o["tensorrt_device"]), nms, conf, o["model_version"], num_classes, p6);
+#endif
+        }
+        else if (type == "onnxruntime")
+        {
+#ifdef ENABLE_ONNXRUNTIME
+            return std::make_unique<yolox_cpp::YoloXONNXRuntime>(
+                o["model_path"],
+                std::stoi(o["onnxruntime_intra_op_num_threads"]), std::stoi(o["onnxruntime_inter_op_num_threads"]),
+                to_bool(o["onnxruntime_use_cuda"]), std::stoi(o["onnxruntime_device_id"]),
+                to_bool(o["onnxruntime_use_parallel"]),
+                nms, conf, o["model_version"], num_classes, p6,
+                std::stoi(o["onnxruntime_warmup_runs"]), to_bool(o["onnxruntime_share_allocator"]),
+                to_bool(o["onnxruntime_cpu_mem_arena"]), o["onnxruntime_optimized_model_path"]);
+#endif
+        }
+        else if (type == "tflite")
+        {
+#ifdef ENABLE_TFLITE
+            return std::make_unique<yolox_cpp::YoloXTflite>(
+                o["model_path"], std::stoi(o["tflite_num_threads"]), nms, conf, o["model_version"], num_classes, p6,
+                to_bool(o["is_nchw"]));
+#endif
+        }
+        else if (type == "null")
+        {
+            return std::make_unique<yolox_cpp::YoloXNull>(
+                o["null_output_path"], std::stoi(o["null_input_width"]), std::stoi(o["null_input_height"]),
+                std::stod(o["null_latency_ms"]), std::stof(o["null_proposal_density"]),
+                nms, conf, o["model_version"], num_classes, p6);
+        }
+        return nullptr;
+    }
+
+    std::vector<cv::Mat> load_frames(Options &o)
+    {
+        std::vector<cv::Mat> frames;
+        if (!o["images"].empty())
+        {
+            std::vector<std::filesystem::path> paths;
+            for (const auto &entry : std::filesystem::directory_iterator(o["images"]))
+            {
+                if (entry.is_regular_file())
+                {
+                    paths.push_back(entry.path());
+                }
+            }
+            // sorted, so every run sees the same order
+            std::sort(paths.begin(), paths.end());
+            for (const auto &path : paths)
+            {
+                cv::Mat img = cv::imread(path.string(), cv::IMREAD_COLOR);
+                if (!img.empty())
+                {
+                    frames.emplace_back(img);
+                }
+            }
+            return frames;
+        }
+
+        // synthetic frames: seeded noise, reproducible between runs
+        cv::RNG rng(std::stoull(o["seed"]));
+        const int num_frames = std::stoi(o["num_frames"]);
+        for (int i = 0; i < num_frames; ++i)
+        {
+            cv::Mat img(std::stoi(o["height"]), std::stoi(o["width"]), CV_8UC3);
+            rng.fill(img, cv::RNG::UNIFORM, 0, 256);
+            frames.emplace_back(img);
+        }
+        return frames;
+    }
+
+    // Exact summary of a sample set, milliseconds
+    std::string summarize(std::vector<double> samples)
+    {
+        std::ostringstream ss;
+        if (samples.empty())
+        {
+            ss << "null";
+            return ss.str();
+        }
+        std::sort(samples.begin(), samples.end());
+        auto at = [&samples](const double q)
+        {
+            const size_t idx = std::min(samples.size() - 1, static_cast<size_t>(q * samples.size()));
+            return samples[idx];
+        };
+        double sum = 0.0;
+        for (const double v : samples)
+        {
+            sum += v;
+        }
+        ss << "{\"mean\": " << sum / samples.size()
+           << ", \"min\": " << samples.front()
+           << ", \"p50\": " << at(0.50)
+           << ", \"p90\": " << at(0.90)
+           << ", \"p95\": " << at(0.95)
+           << ", \"p99\": " << at(0.99)
+           << ", \"max\": " << samples.back() << "}";
+        return ss.str();
+    }
+}
+
+int main(int argc, char **argv)
+{
+    Options options;
+    if (!parse_args(argc, argv, options))
+    {
+        print_usage();
+        return 1;
+    }
+
+    std::unique_ptr<yolox_cpp::AbcYoloX> yolox;
+    try
+    {
+        yolox = create_backend(options);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (yolox == nullptr)
+    {
+        std::cerr << "yolox_cpp is not built with model_type '" << options["model_type"] << "'" << std::endl;
+        return 1;
+    }
+    yolox->set_nms_method(yolox_cpp::nms_method_from_name(options["nms_method"]));
+    yolox->set_class_agnostic_nms(to_bool(options["nms_class_agnostic"]));
+    yolox->set_max_proposals(std::stoi(options["nms_max_proposals"]));
+    try
+    {
+        yolox->set_output_format(yolox_cpp::output_format_from_name(options["output_format"]));
+        yolox->set_dynamic_input(std::stoi(options["dynamic_input_width"]), std::stoi(options["dynamic_input_height"]));
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    const bool tiling = to_bool(options["tiling"]);
+    if (tiling)
+    {
+        yolox->set_tiling(std::stoi(options["tile_width"]), std::stoi(options["tile_height"]),
+                          std::stof(options["tile_overlap"]), to_bool(options["tile_global_view"]));
+    }
+    yolox->set_profiling(true);
+
+    std::vector<cv::Mat> frames;
+    try
+    {
+        frames = load_frames(options);
+    }
+    catch (const std::filesystem::filesystem_error &e)
+    {
+        std::cerr << "cannot read --images " << options["images"] << ": " << e.code().message() << std::endl;
+        return 1;
+    }
+    if (frames.empty())
+    {
+        std::cerr << "no input frames" << std::endl;
+        return 1;
+    }
+
+    const int warmup = std::stoi(options["warmup"]);
+    const int iterations = std::stoi(options["iterations"]);
+    const size_t batch = std::max(1, std::stoi(options["batch"]));
+
+    std::vector<double> latency, preprocess, infer, decode, nms;
+    size_t num_detections = 0;
+    uint64_t num_allocations = 0;
+    size_t next_frame = 0;
+    std::vector<cv::Mat> inputs(batch);
+    std::vector<yolox_cpp::Object> objects;
+    std::chrono::steady_clock::time_point timed_start;
+    for (int i = 0; i < warmup + iterations; ++i)
+    {
+        if (i == warmup)
+        {
+            timed_start = std::chrono::steady_clock::now();
+        }
+        for (auto &input : inputs)
+        {
+            input = frames[next_frame++ % frames.size()];
+        }
+
+        const uint64_t allocations_before = allocation_count.load(std::memory_order_relaxed);
+        const auto start = std::chrono::steady_clock::now();
+        size_t detections = 0;
+        if (tiling)
+        {
+            for (const auto &input : inputs)
+            {
+                yolox->inference_tiled(input, objects);
+                detections += objects.size();
+            }
+        }
+        else if (batch == 1)
+        {
+            yolox->inference(inputs[0], objects);
+            detections = objects.size();
+        }
+        else
+        {
+            for (const auto &objects : yolox->inference_batch(inputs))
+            {
+                detections += objects.size();
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        const uint64_t allocations = allocation_count.load(std::memory_order_relaxed) - allocations_before;
+        if (i < warmup)
+        {
+            continue;
+        }
+
+        const yolox_cpp::StageTimes &times = yolox->last_stage_times();
+        latency.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        preprocess.push_back(times.preprocess / 1000.0);
+        infer.push_back(times.infer / 1000.0);
+        decode.push_back(times.decode / 1000.0);
+        nms.push_back(times.nms / 1000.0);
+        num_detections += detections;
+        num_allocations += allocations;
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - timed_start).count();
+
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"config\": {";
+    bool first = true;
+    for (const auto &kv : options)
+    {
+        json << (first ? "" : ", ") << json_string(kv.first) << ": " << json_string(kv.second);
+        first = false;
+    }
+    json << "},\n";
+    json << "  \"preprocess_kernels\": \"" << yolox_cpp::simd::active_isa() << "\",\n";
+    json << "  \"num_input_frames\": " << frames.size() << ",\n";
+    json << "  \"iterations\": " << iterations << ",\n";
+    json << "  \"throughput_fps\": " << (elapsed > 0.0 ? iterations * batch / elapsed : 0.0) << ",\n";
+    json << "  \"detections_per_frame\": " << (iterations > 0 ? static_cast<double>(num_detections) / (iterations * batch) : 0.0) << ",\n";
+    const double allocations_per_frame = iterations > 0 ? static_cast<double>(num_allocations) / (iterations * batch) : 0.0;
+    json << "  \"allocations_per_frame\": " << allocations_per_frame << ",\n";
+    json << "  \"latency_ms\": " << summarize(latency) << ",\n";
+    json << "  \"stages_ms\": {\n";
+    json << "    \"preprocess\": " << summarize(preprocess) << ",\n";
+    json << "    \"infer\": " << summarize(infer) << ",\n";
+    json << "    \"decode\": " << summarize(decode) << ",\n";
+    json << "    \"nms\": " << summarize(nms) << "\n";
+    json << "  }\n";
+    json << "}\n";
+
+    std::cout << json.str();
+    if (!options["output"].empty())
+    {
+        std::ofstream ofs(options["output"]);
+        ofs << json.str();
+    }
+
+    const double max_allocations = std::stod(options["max_allocations_per_frame"]);
+    if (max_allocations >= 0.0 && allocations_per_frame > max_allocations)
+    {
+        std::cerr << allocations_per_frame << " heap allocations per frame, expected at most "
+                  << max_allocations << std::endl;
+        return 2;
+    }
+    return 0;
+}
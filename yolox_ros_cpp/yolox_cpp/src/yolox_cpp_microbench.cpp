@@ -0,0 +1,216 @@
+// Google Benchmark suite for the AbcYoloX pre/post-processing hot paths.
+// Runs on synthetic frames and head outputs only, no backend or model needed.
+//
+//   yolox_cpp_microbench --benchmark_filter=decode_outputs/640
+//
+// Arguments of the decode benchmarks are: input size, p6, num classes and
+// proposal density (anchors carrying an object, per mille).
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <opencv2/opencv.hpp>
+
+#include "yolox_cpp/core.hpp"
+#include "yolox_cpp/yolox_null.hpp"
+
+namespace
+{
+    using yolox_cpp::Object;
+
+    // Exposes the protected hot paths for a square model input of size x size
+    class CoreBench : public yolox_cpp::AbcYoloX
+    {
+    public:
+        CoreBench(const int size, const int num_classes = 80, const bool p6 = false)
+            : AbcYoloX(0.45, 0.3, "0.1.1rc0", num_classes, p6)
+        {
+            this->input_w_ = size;
+            this->input_h_ = size;
+            generate_anchor_table(size, size, p6 ? this->strides_p6_ : this->strides_, this->anchor_table_);
+        }
+
+        void inference(const cv::Mat &, yolox_cpp::PixelFormat, std::vector<Object> &objects) override
+        {
+            objects.clear();
+        }
+
+        using AbcYoloX::blobFromImage;
+        using AbcYoloX::blobFromImage_nhwc;
+        using AbcYoloX::decode_outputs;
+        using AbcYoloX::generate_yolox_proposals;
+        using AbcYoloX::nms_sorted_bboxes;
+        using AbcYoloX::static_resize;
+
+        const yolox_cpp::AnchorTable &anchor_table() const
+        {
+            return this->anchor_table_;
+        }
+
+        float conf_thresh() const
+        {
+            return this->bbox_conf_thresh_;
+        }
+
+        float nms_thresh() const
+        {
+            return this->nms_thresh_;
+        }
+    };
+
+    constexpr int frame_w = 1280;
+    constexpr int frame_h = 720;
+
+    cv::Mat make_frame(const int w, const int h)
+    {
+        std::mt19937 rng(0);
+        std::uniform_int_distribution<int> pixel(0, 255);
+        cv::Mat img(h, w, CV_8UC3);
+        for (int y = 0; y < h; ++y)
+        {
+            uint8_t *row = img.ptr<uint8_t>(y);
+            for (int x = 0; x < w * 3; ++x)
+            {
+                row[x] = static_cast<uint8_t>(pixel(rng));
+            }
+        }
+        return img;
+    }
+
+    std::vector<float> make_output(const CoreBench &bench, const int num_classes, const int density_pm)
+    {
+        return yolox_cpp::YoloXNull::synthetic_output(bench.anchor_table(), num_classes, density_pm / 1000.0f);
+    }
+
+    void decode_args(benchmark::internal::Benchmark *b)
+    {
+        b->ArgNames({"size", "p6", "classes", "density"});
+        b->ArgsProduct({{416, 640, 1280}, {0, 1}, {1, 80}, {1, 10, 100}});
+    }
+
+    void BM_static_resize(benchmark::State &state)
+    {
+        CoreBench bench(state.range(0));
+        const cv::Mat frame = make_frame(frame_w, frame_h);
+        for (auto _ : state)
+        {
+            cv::Mat out = bench.static_resize(frame);
+            benchmark::DoNotOptimize(out.data);
+        }
+    }
+    BENCHMARK(BM_static_resize)->ArgName("size")->Arg(416)->Arg(640)->Arg(1280);
+
+    void BM_blobFromImage(benchmark::State &state)
+    {
+        const int size = state.range(0);
+        CoreBench bench(size);
+        const cv::Mat img = make_frame(size, size);
+        std::vector<float> blob(static_cast<size_t>(size) * size * 3);
+        for (auto _ : state)
+        {
+            bench.blobFromImage(img, blob.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(img.total() * 3));
+    }
+    BENCHMARK(BM_blobFromImage)->ArgName("size")->Arg(416)->Arg(640)->Arg(1280);
+
+    void BM_blobFromImage_nhwc(benchmark::State &state)
+    {
+        const int size = state.range(0);
+        CoreBench bench(size);
+        const cv::Mat img = make_frame(size, size);
+        std::vector<float> blob(static_cast<size_t>(size) * size * 3);
+        for (auto _ : state)
+        {
+            bench.blobFromImage_nhwc(img, blob.data());
+            benchmark::ClobberMemory();
+        }
+        state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(img.total() * 3));
+    }
+    BENCHMARK(BM_blobFromImage_nhwc)->ArgName("size")->Arg(416)->Arg(640)->Arg(1280);
+
+    void BM_generate_yolox_proposals(benchmark::State &state)
+    {
+        const int num_classes = state.range(2);
+        CoreBench bench(state.range(0), num_classes, state.range(1));
+        const std::vector<float> output = make_output(bench, num_classes, state.range(3));
+        std::vector<Object> proposals;
+        for (auto _ : state)
+        {
+            bench.generate_yolox_proposals(bench.anchor_table(), output.data(), bench.conf_thresh(), proposals);
+            benchmark::DoNotOptimize(proposals.data());
+        }
+        state.counters["anchors"] = bench.anchor_table().size();
+        state.counters["proposals"] = proposals.size();
+    }
+    BENCHMARK(BM_generate_yolox_proposals)->Apply(decode_args);
+
+    void BM_nms_sorted_bboxes(benchmark::State &state)
+    {
+        const int num_classes = state.range(2);
+        CoreBench bench(state.range(0), num_classes, state.range(1));
+        const std::vector<float> output = make_output(bench, num_classes, state.range(3));
+        std::vector<Object> proposals;
+        bench.generate_yolox_proposals(bench.anchor_table(), output.data(), bench.conf_thresh(), proposals);
+        std::sort(proposals.begin(), proposals.end(), [](const Object &a, const Object &b)
+                  { return a.prob > b.prob; });
+        std::vector<int> picked;
+        for (auto _ : state)
+        {
+            bench.nms_sorted_bboxes(proposals, picked, bench.nms_thresh());
+            benchmark::DoNotOptimize(picked.data());
+        }
+        state.counters["proposals"] = proposals.size();
+        state.counters["picked"] = picked.size();
+    }
+    BENCHMARK(BM_nms_sorted_bboxes)->Apply(decode_args);
+
+    void BM_decode_outputs(benchmark::State &state)
+    {
+        const int size = state.range(0);
+        const int num_classes = state.range(2);
+        CoreBench bench(size, num_classes, state.range(1));
+        const std::vector<float> output = make_output(bench, num_classes, state.range(3));
+        const float scale = std::min(static_cast<float>(size) / frame_w, static_cast<float>(size) / frame_h);
+        std::vector<Object> objects;
+        for (auto _ : state)
+        {
+            bench.decode_outputs(output.data(), bench.anchor_table(), objects, bench.conf_thresh(),
+                                 scale, frame_w, frame_h);
+            benchmark::DoNotOptimize(objects.data());
+        }
+        state.counters["objects"] = objects.size();
+    }
+    BENCHMARK(BM_decode_outputs)->Apply(decode_args);
+
+    // uint8 head output, as produced by fully quantized TFLite models
+    void BM_decode_outputs_u8(benchmark::State &state)
+    {
+        const int size = state.range(0);
+        const int num_classes = state.range(2);
+        CoreBench bench(size, num_classes, state.range(1));
+        const std::vector<float> output = make_output(bench, num_classes, state.range(3));
+        const yolox_cpp::Quantization quant{1.0f / 128.0f, 0};
+        std::vector<uint8_t> output_u8(output.size());
+        for (size_t i = 0; i < output.size(); ++i)
+        {
+            output_u8[i] = static_cast<uint8_t>(std::min(255.0f, std::round(output[i] / quant.scale)));
+        }
+        const float scale = std::min(static_cast<float>(size) / frame_w, static_cast<float>(size) / frame_h);
+        std::vector<Object> objects;
+        for (auto _ : state)
+        {
+            bench.decode_outputs(output_u8.data(), quant, bench.anchor_table(), objects, bench.conf_thresh(),
+                                 scale, frame_w, frame_h);
+            benchmark::DoNotOptimize(objects.data());
+        }
+        state.counters["objects"] = objects.size();
+    }
+    BENCHMARK(BM_decode_outputs_u8)->Apply(decode_args);
+}
+
+BENCHMARK_MAIN();
@@ -0,0 +1,117 @@
+#include "yolox_cpp/yolox_null.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <thread>
+
+namespace yolox_cpp{
+
+    YoloXNull::YoloXNull(const file_name_t &path_to_output, int input_w, int input_h,
+                         double latency_ms, float proposal_density,
+                         float nms_th, float conf_th, const std::string &model_version,
+                         int num_classes, bool p6)
+    :AbcYoloX(nms_th, conf_th, model_version, num_classes, p6),
+     latency_(latency_ms)
+    {
+        this->input_w_ = input_w;
+        this->input_h_ = input_h;
+        this->input_blob_.resize(static_cast<size_t>(input_w) * input_h * 3);
+
+        // Prepare anchor table
+        if(this->p6_)
+        {
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_p6_, this->anchor_table_);
+        }
+        else
+        {
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_, this->anchor_table_);
+        }
+
+        if (path_to_output.empty())
+        {
+            this->output_ = synthetic_output(this->anchor_table_, this->num_classes_, proposal_density);
+        }
+        else
+        {
+            load_output(path_to_output);
+        }
+    }
+
+    void YoloXNull::load_output(const file_name_t &path_to_output)
+    {
+        const size_t output_size = this->anchor_table_.size() * (this->num_classes_ + 5);
+        std::ifstream ifs(path_to_output, std::ios::binary | std::ios::ate);
+        if (!ifs)
+        {
+            std::string msg = "Failed to open " + path_to_output;
+            throw std::runtime_error(msg.c_str());
+        }
+        const size_t file_size = ifs.tellg();
+        if (file_size != output_size * sizeof(float))
+        {
+            std::string msg = path_to_output + " has " + std::to_string(file_size) + " bytes, expected " +
+                              std::to_string(output_size * sizeof(float)) + " (float32 output of " +
+                              std::to_string(this->input_w_) + "x" + std::to_string(this->input_h_) + " input, " +
+                              std::to_string(this->num_classes_) + " classes)";
+            throw std::runtime_error(msg.c_str());
+        }
+        this->output_.resize(output_size);
+        ifs.seekg(0);
+        ifs.read(reinterpret_cast<char *>(this->output_.data()), file_size);
+    }
+
+    std::vector<float> YoloXNull::synthetic_output(const AnchorTable &anchors,
+                                                   int num_classes, float proposal_density)
+    {
+        // fixed seed: every run decodes the same tensor
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::uniform_int_distribution<int> label(0, num_classes - 1);
+
+        const size_t num_anchors = anchors.size();
+        const int num_attrs = num_classes + 5;
+        std::vector<float> output(num_anchors * num_attrs);
+        for (size_t i = 0; i < num_anchors; ++i)
+        {
+            // boxes of 1-4 strides, so objects on neighbouring anchors overlap
+            float *attrs = output.data() + i * num_attrs;
+            attrs[0] = unit(rng);
+            attrs[1] = unit(rng);
+            attrs[2] = std::log(1.0f + 3.0f * unit(rng));
+            attrs[3] = std::log(1.0f + 3.0f * unit(rng));
+            const bool is_object = unit(rng) < proposal_density;
+            attrs[4] = is_object ? 0.6f + 0.4f * unit(rng) : 0.05f * unit(rng);
+            for (int c = 0; c < num_classes; ++c)
+            {
+                attrs[5 + c] = 0.3f * unit(rng);
+            }
+            if (is_object)
+            {
+                attrs[5 + label(rng)] = 0.7f + 0.3f * unit(rng);
+            }
+        }
+        return output;
+    }
+
+    void YoloXNull::inference(const cv::Mat& frame, const PixelFormat format, std::vector<Object>& objects)
+    {
+        // preprocess
+        blobFromImage_letterbox(frame, format, this->input_blob_.data());
+
+        // "inference"
+        if (this->latency_.count() > 0.0)
+        {
+            std::this_thread::sleep_for(this->latency_);
+        }
+
+        // postprocess
+        const cv::Size size = image_size(frame, format);
+        const float scale = std::min(
+            static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+            static_cast<float>(this->input_h_) / static_cast<float>(size.height)
+        );
+        decode_outputs(this->output_.data(), this->anchor_table_, objects, this->bbox_conf_thresh_, scale, size.width, size.height);
+    }
+
+}
@@ -1,12 +1,68 @@
 #include "yolox_cpp/yolox_onnxruntime.hpp"
 
+#include <filesystem>
+#include <mutex>
+#include <sstream>
+
 namespace yolox_cpp{
 
+    namespace
+    {
+        std::string shape_to_string(const std::vector<int64_t> &shape)
+        {
+            std::ostringstream ss;
+            ss << "[";
+            for (size_t i = 0; i < shape.size(); i++)
+            {
+                ss << (i ? ", " : "") << shape[i];
+            }
+            ss << "]";
+            return ss.str();
+        }
+
+        // One environment for every session of the process (ORT expects a single
+        // Ort::Env), created with the first session and outliving all of them.
+        Ort::Env &ort_env()
+        {
+            static Ort::Env env{ORT_LOGGING_LEVEL_WARNING, "Default"};
+            return env;
+        }
+
+        // One CPU arena for every session of the process that opts in with
+        // session.use_env_allocators, instead of an arena per session.
+        void register_shared_allocator()
+        {
+            static std::once_flag registered;
+            std::call_once(registered, []()
+            {
+                const auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
+                // defaults: no limit, kNextPowerOfTwo, default chunk sizes
+                const Ort::ArenaCfg arena_cfg(0, -1, -1, -1);
+                ort_env().CreateAndRegisterAllocator(memory_info, arena_cfg);
+            });
+        }
+
+        // an optimized model written before the source model was last modified is stale
+        bool is_fresh(const std::string &optimized_model_path, const std::string &model_path)
+        {
+            std::error_code ec;
+            const auto optimized_time = std::filesystem::last_write_time(optimized_model_path, ec);
+            if (ec)
+            {
+                return false;
+            }
+            const auto model_time = std::filesystem::last_write_time(model_path, ec);
+            return !ec && optimized_time >= model_time;
+        }
+    }
+
     YoloXONNXRuntime::YoloXONNXRuntime(const file_name_t &path_to_model,
                                        int intra_op_num_threads, int inter_op_num_threads,
                                        bool use_cuda, int device_id, bool use_parallel,
                                        float nms_th, float conf_th, const std::string &model_version,
-                                       int num_classes, bool p6)
+                                       int num_classes, bool p6,
+                                       int warmup_runs, bool share_allocator, bool cpu_mem_arena,
+                                       const std::string &optimized_model_path)
     :AbcYoloX(nms_th, conf_th, model_version, num_classes, p6),
      intra_op_num_threads_(intra_op_num_threads), inter_op_num_threads_(inter_op_num_threads),
      use_cuda_(use_cuda), device_id_(device_id), use_parallel_(use_parallel)
@@ -15,7 +71,32 @@ namespace yolox_cpp{
         {
             Ort::SessionOptions session_options;
 
-            session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+            // A serialized optimized model skips graph optimization at startup. It is
+            // specific to this machine and execution provider, and rewritten when stale.
+            std::string model_path = path_to_model;
+            if (!optimized_model_path.empty() && is_fresh(optimized_model_path, path_to_model))
+            {
+                std::cout << "Load optimized model: " << optimized_model_path << std::endl;
+                model_path = optimized_model_path;
+                session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_DISABLE_ALL);
+            }
+            else
+            {
+                session_options.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+                if (!optimized_model_path.empty())
+                {
+                    session_options.SetOptimizedModelFilePath(optimized_model_path.c_str());
+                }
+            }
+            if (!cpu_mem_arena)
+            {
+                session_options.DisableCpuMemArena();
+            }
+            else if (share_allocator)
+            {
+                register_shared_allocator();
+                session_options.AddConfigEntry("session.use_env_allocators", "1");
+            }
             if(this->use_parallel_)
             {
                 session_options.SetExecutionMode(ExecutionMode::ORT_PARALLEL);
@@ -34,8 +115,8 @@ namespace yolox_cpp{
                 session_options.AppendExecutionProvider_CUDA(cuda_option);
             }
 
-            this->session_ = Ort::Session(this->env_,
-                                          path_to_model.c_str(),
+            this->session_ = Ort::Session(ort_env(),
+                                          model_path.c_str(),
                                           session_options);
         }
         catch (std::exception &e)
@@ -47,25 +128,41 @@ namespace yolox_cpp{
         Ort::AllocatorWithDefaultOptions ort_alloc;
 
         // Allocate input memory buffer
-        std::cout << "input:" << std::endl;
         this->input_name_ = std::string(this->session_.GetInputNameAllocated(0, ort_alloc).get());
         // this->input_name_ = this->session_.GetInputName(0, ort_alloc);
-        std::cout << " name: " << this->input_name_ << std::endl;
         auto input_info = this->session_.GetInputTypeInfo(0);
         auto input_shape_info = input_info.GetTensorTypeAndShapeInfo();
         std::vector<int64_t> input_shape = input_shape_info.GetShape();
         ONNXTensorElementDataType  input_tensor_type = input_shape_info.GetElementType();
+        this->input_tensor_type_ = input_tensor_type;
+        std::cout << "input: " << this->input_name_ << " " << shape_to_string(input_shape)
+                  << " type " << input_tensor_type << std::endl;
+
+        // A dynamic batch dimension lets inference_batch() run several frames per call.
+        // Single frames use batch 1.
+        this->dynamic_batch_ = input_shape[0] < 0;
+        if (this->dynamic_batch_)
+        {
+            input_shape[0] = 1;
+        }
+        // A dynamic H / W is run at default_input_size_ until set_dynamic_input() is called.
+        this->dynamic_hw_ = input_shape[2] < 0 || input_shape[3] < 0;
+        if (this->dynamic_hw_)
+        {
+            input_shape[2] = default_input_size_;
+            input_shape[3] = default_input_size_;
+        }
         this->input_h_ = input_shape[2];
         this->input_w_ = input_shape[3];
-
-        std::cout << " shape:" << std::endl;
+        this->input_shape_ = input_shape;
+        this->batch_input_shape_ = input_shape;
+        this->input_size_ = 1;
         for (size_t i = 0; i < input_shape.size(); i++)
         {
-            std::cout << "   - " << input_shape[i] << std::endl;
+            this->input_size_ *= input_shape[i];
         }
-        std::cout << " tensor_type: " << input_tensor_type << std::endl;
 
-        size_t input_byte_count = sizeof(float) * input_shape_info.GetElementCount();
+        size_t input_byte_count = sizeof(float) * this->input_size_;
         std::unique_ptr<uint8_t[]> input_buffer = std::make_unique<uint8_t[]>(input_byte_count);
         // auto input_memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
         auto input_memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
@@ -77,24 +174,39 @@ namespace yolox_cpp{
         this->input_buffer_.emplace_back(std::move(input_buffer));
 
         // Allocate output memory buffer
-        std::cout << "outputs" << std::endl;
         this->output_name_ = std::string(this->session_.GetOutputNameAllocated(0, ort_alloc).get());
         // this->output_name_ = this->session_.GetOutputName(0, ort_alloc);
-        std::cout << " name: " << this->output_name_ << std::endl;
-
         auto output_info = this->session_.GetOutputTypeInfo(0);
         auto output_shape_info = output_info.GetTensorTypeAndShapeInfo();
         auto output_shape = output_shape_info.GetShape();
         auto output_tensor_type = output_shape_info.GetElementType();
+        std::cout << "output: " << this->output_name_ << " " << shape_to_string(output_shape)
+                  << " type " << output_tensor_type << std::endl;
 
-        std::cout << " shape:" << std::endl;
+        if (output_shape[0] < 0)
+        {
+            output_shape[0] = 1;
+        }
+        if (this->dynamic_hw_)
+        {
+            output_shape[1] = num_anchors(this->input_w_, this->input_h_);
+            output_shape[2] = this->num_classes_ + 5;
+        }
+        // the detection count of an in-graph NMS output; that output is allocated by Run()
+        for (auto &dim : output_shape)
+        {
+            dim = std::max<int64_t>(dim, 1);
+        }
+        this->output_tensor_type_ = output_tensor_type;
+        this->output_shape_ = output_shape;
+        this->batch_output_shape_ = output_shape;
+        this->output_size_ = 1;
         for (size_t i = 0; i < output_shape.size(); i++)
         {
-            std::cout << "   - " << output_shape[i] << std::endl;
+            this->output_size_ *= output_shape[i];
         }
-        std::cout << " tensor_type: " << output_tensor_type << std::endl;
 
-        size_t output_byte_count = sizeof(float) * output_shape_info.GetElementCount();
+        size_t output_byte_count = sizeof(float) * this->output_size_;
         std::unique_ptr<uint8_t[]> output_buffer = std::make_unique<uint8_t[]>(output_byte_count);
         // auto output_memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeDefault);
         auto output_memory_info = Ort::MemoryInfo::CreateCpu(OrtDeviceAllocator, OrtMemTypeCPU);
@@ -105,45 +217,188 @@ namespace yolox_cpp{
                                                         output_tensor_type);
         this->output_buffer_.emplace_back(std::move(output_buffer));
 
-        // Prepare GridAndStrides
+        this->io_binding_ = Ort::IoBinding(this->session_);
+        this->io_binding_.BindInput(this->input_name_.c_str(), this->input_tensor_);
+        this->io_binding_.BindOutput(this->output_name_.c_str(), this->output_tensor_);
+
+        // The first runs pay for lazy initialization (kernels, arena growth, CUDA context),
+        // so they are done here rather than on the first frame. The output is left to the
+        // runtime, its shape may be dynamic.
+        {
+            const char* input_names_[] = {this->input_name_.c_str()};
+            const char* output_names_[] = {this->output_name_.c_str()};
+            for (int i = 0; i < warmup_runs; ++i)
+            {
+                this->session_.Run(this->run_options_, input_names_, &this->input_tensor_, 1, output_names_, 1);
+            }
+        }
+
+        // Prepare anchor table
         if(this->p6_)
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_p6_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_p6_, this->anchor_table_);
         }
         else
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_, this->anchor_table_);
         }
     }
 
-    std::vector<Object> YoloXONNXRuntime::inference(const cv::Mat& frame)
+    void YoloXONNXRuntime::check_nms_output() const
     {
-        // preprocess
-        cv::Mat pr_img = static_resize(frame);
+        const auto output_info = this->session_.GetOutputTypeInfo(0);
+        const auto shape = output_info.GetTensorTypeAndShapeInfo().GetShape();
+        const bool rows_of_7 = shape.size() >= 2 && (shape.back() == 7 || shape.back() < 0);
+        if (this->output_tensor_type_ != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT || !rows_of_7)
+        {
+            std::string msg = "output " + this->output_name_ + " " + shape_to_string(shape) + " type " +
+                              std::to_string(this->output_tensor_type_) +
+                              " is not an in-graph NMS output, expected float [N, 7]";
+            throw std::runtime_error(msg.c_str());
+        }
+    }
 
+    size_t YoloXONNXRuntime::num_anchors(const int input_w, const int input_h) const
+    {
+        size_t n = 0;
+        for (const int stride : (this->p6_ ? this->strides_p6_ : this->strides_))
+        {
+            n += static_cast<size_t>(input_w / stride) * (input_h / stride);
+        }
+        return n;
+    }
+
+    YoloXONNXRuntime::ShapeBuffers &YoloXONNXRuntime::shape_buffers(const cv::Size &size)
+    {
+        for (auto &buffers : this->shape_buffers_)
+        {
+            if (buffers->size == size)
+            {
+                return *buffers;
+            }
+        }
+
+        // first frame of this size: allocate its buffers and tensors once
+        auto buffers = std::make_unique<ShapeBuffers>();
+        buffers->size = size;
+        buffers->input_shape = {1, this->input_shape_[1], size.height, size.width};
+        buffers->output_shape = {1, static_cast<int64_t>(num_anchors(size.width, size.height)), this->num_classes_ + 5};
+        buffers->input.resize(3 * static_cast<size_t>(size.width) * size.height);
+        buffers->output.resize(buffers->output_shape[1] * buffers->output_shape[2]);
+        buffers->input_tensor = Ort::Value::CreateTensor(this->cpu_memory_info_,
+                                                         buffers->input.data(), buffers->input.size() * sizeof(float),
+                                                         buffers->input_shape.data(), buffers->input_shape.size(),
+                                                         this->input_tensor_type_);
+        buffers->output_tensor = Ort::Value::CreateTensor(this->cpu_memory_info_,
+                                                          buffers->output.data(), buffers->output.size() * sizeof(float),
+                                                          buffers->output_shape.data(), buffers->output_shape.size(),
+                                                          this->output_tensor_type_);
+        buffers->binding = Ort::IoBinding(this->session_);
+        buffers->binding.BindInput(this->input_name_.c_str(), buffers->input_tensor);
+        buffers->binding.BindOutput(this->output_name_.c_str(), buffers->output_tensor);
+        this->shape_buffers_.emplace_back(std::move(buffers));
+        return *this->shape_buffers_.back();
+    }
+
+    void YoloXONNXRuntime::inference(const cv::Mat& frame, const PixelFormat format, std::vector<Object>& objects)
+    {
         float *blob_data = (float *)(this->input_buffer_[0].get());
-        blobFromImage(pr_img, blob_data);
+        float *net_pred = (float *)this->output_buffer_[0].get();
+        Ort::Value *input_tensor = &this->input_tensor_;
+        Ort::IoBinding *binding = &this->io_binding_;
+        const cv::Size size = image_size(frame, format);
+        if (this->dynamic_input())
+        {
+            use_input_size(select_input_size(size.width, size.height));
+            ShapeBuffers &buffers = shape_buffers(cv::Size(this->input_w_, this->input_h_));
+            blob_data = buffers.input.data();
+            net_pred = buffers.output.data();
+            input_tensor = &buffers.input_tensor;
+            binding = &buffers.binding;
+        }
+
+        // preprocess
+        blobFromImage_letterbox(frame, format, blob_data);
+
+        const char* input_names_[] = {this->input_name_.c_str()};
+        const char* output_names_[] = {this->output_name_.c_str()};
+        const float scale = std::min(
+            static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+            static_cast<float>(this->input_h_) / static_cast<float>(size.height)
+        );
+
+        if (this->output_format_ == OutputFormat::NMS)
+        {
+            // the number of detections varies per frame, so the runtime allocates the output
+            auto outputs = this->session_.Run(this->run_options_,
+                                              input_names_,
+                                              input_tensor, 1,
+                                              output_names_, 1);
+            // element type and row size were checked by set_output_format
+            const size_t num_values = outputs[0].GetTensorTypeAndShapeInfo().GetElementCount();
+            decode_detections(outputs[0].GetTensorData<float>(), num_values / 7, objects,
+                              this->bbox_conf_thresh_, scale, size.width, size.height);
+            return;
+        }
+
+        // Inference, into the bound output buffer
+        this->session_.Run(this->run_options_, *binding);
+
+        // postprocess
+        if (this->output_tensor_type_ == ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT16)
+        {
+            // fp16 head, read as is
+            decode_outputs(reinterpret_cast<const Float16 *>(net_pred), Quantization(), this->anchor_table_, objects,
+                           this->bbox_conf_thresh_, scale, size.width, size.height);
+        }
+        else
+        {
+            decode_outputs(net_pred, this->anchor_table_, objects, this->bbox_conf_thresh_, scale, size.width, size.height);
+        }
+    }
+
+    std::vector<std::vector<Object>> YoloXONNXRuntime::inference_batch(const std::vector<cv::Mat>& frames, const PixelFormat format)
+    {
+        const size_t batch = frames.size();
+        // with a dynamic input size every frame may get its own shape
+        // the batch tensors are float only
+        if (!this->dynamic_batch_ || batch <= 1 || this->dynamic_input() ||
+            this->output_tensor_type_ != ONNX_TENSOR_ELEMENT_DATA_TYPE_FLOAT ||
+            this->output_format_ == OutputFormat::NMS)
+        {
+            return AbcYoloX::inference_batch(frames, format);
+        }
+
+        // preprocess: one N x 3 x H x W blob
+        this->batch_input_.resize(batch * this->input_size_);
+        this->batch_output_.resize(batch * this->output_size_);
+        for (size_t b = 0; b < batch; ++b)
+        {
+            blobFromImage_letterbox(frames[b], format, this->batch_input_.data() + b * this->input_size_);
+        }
+
+        this->batch_input_shape_[0] = batch;
+        this->batch_output_shape_[0] = batch;
+        Ort::Value input_tensor = Ort::Value::CreateTensor<float>(this->cpu_memory_info_,
+                                                                  this->batch_input_.data(), this->batch_input_.size(),
+                                                                  this->batch_input_shape_.data(), this->batch_input_shape_.size());
+        Ort::Value output_tensor = Ort::Value::CreateTensor<float>(this->cpu_memory_info_,
+                                                                   this->batch_output_.data(), this->batch_output_.size(),
+                                                                   this->batch_output_shape_.data(), this->batch_output_shape_.size());
 
         const char* input_names_[] = {this->input_name_.c_str()};
         const char* output_names_[] = {this->output_name_.c_str()};
 
         // Inference
-        Ort::RunOptions run_options;
-        this->session_.Run(run_options,
+        this->session_.Run(this->run_options_,
                            input_names_,
-                           &this->input_tensor_, 1,
+                           &input_tensor, 1,
                            output_names_,
-                           &this->output_tensor_, 1);
-
-        float* net_pred = (float *)this->output_buffer_[0].get();
+                           &output_tensor, 1);
 
         // postprocess
-        const float scale = std::min(
-            static_cast<float>(this->input_w_) / static_cast<float>(frame.cols),
-            static_cast<float>(this->input_h_) / static_cast<float>(frame.rows)
-        );
-        std::vector<Object> objects;
-        decode_outputs(net_pred, this->grid_strides_, objects, this->bbox_conf_thresh_, scale, frame.cols, frame.rows);
+        std::vector<std::vector<Object>> objects;
+        decode_outputs_batch(this->batch_output_.data(), this->output_size_, frames, format, objects);
         return objects;
     }
 
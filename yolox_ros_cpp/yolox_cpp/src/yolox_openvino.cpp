@@ -3,18 +3,51 @@
 namespace yolox_cpp{
     YoloXOpenVINO::YoloXOpenVINO(const file_name_t &path_to_model, std::string device_name,
                                  float nms_th, float conf_th, const std::string &model_version,
-                                 int num_classes, bool p6)
+                                 int num_classes, bool p6, int num_infer_requests,
+                                 const std::string &cache_dir, bool embed_preprocess)
     :AbcYoloX(nms_th, conf_th, model_version, num_classes, p6),
-     device_name_(device_name)
+     device_name_(device_name), num_infer_requests_(num_infer_requests)
     {
         // Step 1. Initialize inference engine core
         std::cout << "Initialize Inference engine core" << std::endl;
         ov::Core ie;
+        if (!cache_dir.empty())
+        {
+            // compiled blobs are reused on the next start with the same model and device
+            std::cout << "Model cache: " << cache_dir << std::endl;
+            ie.set_property(ov::cache_dir(cache_dir));
+        }
 
         // Step 2. Read a model in OpenVINO Intermediate Representation (.xml and
         // .bin files) or ONNX (.onnx file) format
         std::cout << "Read a model in OpenVINO Intermediate Representation: " << path_to_model << std::endl;
-        const auto network = ie.read_model(path_to_model);
+        auto network = ie.read_model(path_to_model);
+        // A dynamic batch dimension lets inference_batch() run several frames per request.
+        // A dynamic H / W is run at default_input_size_ until set_dynamic_input() is called.
+        const ov::PartialShape input_partial_shape = network->input().get_partial_shape();
+        this->dynamic_batch_ = input_partial_shape[0].is_dynamic();
+        this->dynamic_hw_ = input_partial_shape[2].is_dynamic() || input_partial_shape[3].is_dynamic();
+
+        if (embed_preprocess)
+        {
+            // The letterboxed uint8 BGR frame is fed as is; layout conversion and
+            // normalization run in the plugin.
+            std::cout << "Embed preprocessing: u8 NHWC -> f32 NCHW" << std::endl;
+            ov::preprocess::PrePostProcessor ppp(network);
+            ppp.input().tensor().set_element_type(ov::element::u8).set_layout("NHWC");
+            ppp.input().model().set_layout("NCHW");
+            auto &steps = ppp.input().preprocess();
+            steps.convert_element_type(ov::element::f32);
+            if (this->normalize_mode_ == NormalizeMode::MEAN_STD)
+            {
+                // (x - mean) / std with x in [0, 255]
+                steps.mean({0.485f * 255.0f, 0.456f * 255.0f, 0.406f * 255.0f});
+                steps.scale({0.229f * 255.0f, 0.224f * 255.0f, 0.225f * 255.0f});
+            }
+            network = ppp.build();
+            this->set_normalize_mode(NormalizeMode::NONE);
+            this->input_nhwc_ = true;
+        }
 
         //  Step 3. Loading a model to the device
         std::vector<std::string> available_devices = ie.get_available_devices();
@@ -24,7 +57,31 @@ namespace yolox_cpp{
         }
         std::cout << "==============================================" << std::endl;
         std::cout << "Loading a model to the device: " << device_name_ << std::endl;
-        auto compiled_model = ie.compile_model(network, device_name);
+        ov::CompiledModel compiled_model;
+        if (this->num_infer_requests_ == 1)
+        {
+            compiled_model = ie.compile_model(network, device_name);
+        }
+        else
+        {
+            // Async mode: let the plugin spread requests over its streams.
+            // 0 lets the plugin pick the number of requests.
+            compiled_model = ie.compile_model(
+                network, device_name,
+                ov::hint::performance_mode(ov::hint::PerformanceMode::THROUGHPUT),
+                ov::hint::num_requests(this->num_infer_requests_));
+            if (this->num_infer_requests_ == 0)
+            {
+                this->num_infer_requests_ = compiled_model.get_property(ov::optimal_number_of_infer_requests);
+                if (this->num_infer_requests_ <= 1)
+                {
+                    // nothing to overlap: synchronous mode, compiled as for 1
+                    std::cout << "Optimal number of infer requests is 1, compile for latency" << std::endl;
+                    this->num_infer_requests_ = 1;
+                    compiled_model = ie.compile_model(network, device_name);
+                }
+            }
+        }
 
         // Step 4. Create an infer request
         std::cout << "Create an infer request" << std::endl;
@@ -32,7 +89,12 @@ namespace yolox_cpp{
 
         // Step 5. Configure input & output
         std::cout << "Configuring input and output blobs" << std::endl;
-        this->input_shape_ = compiled_model.input(0).get_shape();
+        // input_shape_ is NCHW, also with an embedded NHWC input
+        this->input_shape_ = {
+            1,
+            static_cast<size_t>(input_partial_shape[1].get_length()),
+            this->dynamic_hw_ ? default_input_size_ : static_cast<size_t>(input_partial_shape[2].get_length()),
+            this->dynamic_hw_ ? default_input_size_ : static_cast<size_t>(input_partial_shape[3].get_length())};
         /* Mark input as resizable by setting of a resize algorithm.
         * In this case we will be able to set an input blob of any shape to an
         * infer request. Resize and layout conversions are executed automatically
@@ -40,45 +102,286 @@ namespace yolox_cpp{
         this->blob_.resize(
             this->input_shape_.at(0) * this->input_shape_.at(1) *
             this->input_shape_.at(2) * this->input_shape_.at(3));
+        this->input_type_ = compiled_model.input(0).get_element_type();
+        this->output_type_ = compiled_model.output(0).get_element_type();
+        this->output_shape_ = compiled_model.output(0).get_partial_shape();
+        this->input_tensor_ = make_input_tensor(this->input_shape_, this->blob_.data());
         this->input_h_ = this->input_shape_.at(2);
         this->input_w_ = this->input_shape_.at(3);
         std::cout << "INPUT_HEIGHT: " << this->input_h_ << std::endl;
         std::cout << "INPUT_WIDTH: " << this->input_w_ << std::endl;
+        std::cout << "DYNAMIC_BATCH: " << (this->dynamic_batch_ ? "true" : "false") << std::endl;
+        std::cout << "DYNAMIC_HW: " << (this->dynamic_hw_ ? "true" : "false") << std::endl;
+        std::cout << "INPUT_TYPE: " << this->input_type_ << std::endl;
+        std::cout << "OUTPUT_TYPE: " << this->output_type_ << std::endl;
 
-        // Prepare GridAndStrides
+        // Request pool for async mode, each request with its own input blob
+        if (this->num_infer_requests_ > 1)
+        {
+            std::cout << "Create " << this->num_infer_requests_ << " async infer requests" << std::endl;
+            this->async_blobs_.resize(this->num_infer_requests_);
+            for (int i = 0; i < this->num_infer_requests_; ++i)
+            {
+                this->async_blobs_[i].resize(this->blob_.size());
+                this->async_requests_.emplace_back(compiled_model.create_infer_request());
+                this->async_requests_[i].set_input_tensor(
+                    make_input_tensor(this->input_shape_, this->async_blobs_[i].data()));
+            }
+        }
+
+        // Prepare anchor table
         if(this->p6_)
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_p6_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_p6_, this->anchor_table_);
+        }
+        else
+        {
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_, this->anchor_table_);
+        }
+    }
+
+    ov::Tensor &YoloXOpenVINO::shape_tensor(const cv::Size &size)
+    {
+        for (auto &blob : this->shape_blobs_)
+        {
+            if (blob->size == size)
+            {
+                return blob->tensor;
+            }
+        }
+
+        // first frame of this size: allocate its blob once
+        auto blob = std::make_unique<ShapeBlob>();
+        blob->size = size;
+        blob->data.resize(this->input_shape_.at(1) * size.height * size.width);
+        blob->tensor = make_input_tensor(
+            ov::Shape{1, this->input_shape_.at(1), static_cast<size_t>(size.height), static_cast<size_t>(size.width)},
+            blob->data.data());
+        this->shape_blobs_.emplace_back(std::move(blob));
+        return this->shape_blobs_.back()->tensor;
+    }
+
+    void YoloXOpenVINO::check_nms_output() const
+    {
+        const ov::PartialShape &shape = this->output_shape_;
+        const bool rows_of_7 = shape.rank().is_static() && shape.size() >= 2 &&
+                               (shape[shape.size() - 1].is_dynamic() || shape[shape.size() - 1].get_length() == 7);
+        if (this->output_type_ != ov::element::f32 || !rows_of_7)
+        {
+            std::string msg = "output " + shape.to_string() + " type " + this->output_type_.get_type_name() +
+                              " is not an in-graph NMS output, expected f32 [N, 7]";
+            throw std::runtime_error(msg.c_str());
+        }
+    }
+
+    ov::Tensor YoloXOpenVINO::make_input_tensor(const ov::Shape &shape, float *data) const
+    {
+        // u8 tensors own their (4x smaller) memory, data is left unused
+        if (this->input_nhwc_)
+        {
+            return ov::Tensor{ov::element::u8, ov::Shape{shape[0], shape[2], shape[3], shape[1]}};
+        }
+        if (this->input_type_ == ov::element::u8)
+        {
+            return ov::Tensor{ov::element::u8, shape};
+        }
+        return ov::Tensor{ov::element::f32, shape, data};
+    }
+
+    void YoloXOpenVINO::write_input(const cv::Mat &frame, const PixelFormat format, ov::Tensor &tensor)
+    {
+        if (this->input_nhwc_)
+        {
+            blobFromImage_letterbox_nhwc(frame, format, tensor.data<uint8_t>(), Quantization());
+        }
+        else if (tensor.get_element_type() == ov::element::u8)
+        {
+            blobFromImage_letterbox(frame, format, tensor.data<uint8_t>(), Quantization());
+        }
+        else
+        {
+            blobFromImage_letterbox(frame, format, tensor.data<float>());
+        }
+    }
+
+    void YoloXOpenVINO::decode_output(const ov::Tensor &output_tensor, const cv::Size &size,
+                                      std::vector<Object> &objects, DecodeScratch *scratch)
+    {
+        const float scale = std::min(
+            static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+            static_cast<float>(this->input_h_) / static_cast<float>(size.height)
+        );
+        if (this->output_format_ == OutputFormat::NMS)
+        {
+            // the output shape is set by the last infer, N x 7
+            const float *rows = output_tensor.data<const float>();
+            if (scratch)
+            {
+                decode_detections(rows, output_tensor.get_size() / 7, objects, this->bbox_conf_thresh_,
+                                  scale, size.width, size.height, *scratch);
+            }
+            else
+            {
+                decode_detections(rows, output_tensor.get_size() / 7, objects, this->bbox_conf_thresh_,
+                                  scale, size.width, size.height);
+            }
+            return;
+        }
+        if (output_tensor.get_element_type() == ov::element::f16)
+        {
+            // fp16 head, read as is
+            const Float16 *net_pred = reinterpret_cast<const Float16 *>(output_tensor.data());
+            if (scratch)
+            {
+                decode_outputs(net_pred, Quantization(), this->anchor_table_, objects, this->bbox_conf_thresh_,
+                               scale, size.width, size.height, *scratch);
+            }
+            else
+            {
+                decode_outputs(net_pred, Quantization(), this->anchor_table_, objects, this->bbox_conf_thresh_,
+                               scale, size.width, size.height);
+            }
+            return;
+        }
+        const float *net_pred = reinterpret_cast<const float *>(output_tensor.data());
+        if (scratch)
+        {
+            decode_outputs(net_pred, this->anchor_table_, objects, this->bbox_conf_thresh_,
+                           scale, size.width, size.height, *scratch);
         }
         else
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_, this->grid_strides_);
+            decode_outputs(net_pred, this->anchor_table_, objects, this->bbox_conf_thresh_,
+                           scale, size.width, size.height);
         }
     }
 
-    std::vector<Object> YoloXOpenVINO::inference(const cv::Mat& frame)
+    void YoloXOpenVINO::inference(const cv::Mat& frame, const PixelFormat format, std::vector<Object>& objects)
     {
+        ov::Tensor *input_tensor = &this->input_tensor_;
+        const cv::Size size = image_size(frame, format);
+        if (this->dynamic_input())
+        {
+            use_input_size(select_input_size(size.width, size.height));
+            input_tensor = &shape_tensor(cv::Size(this->input_w_, this->input_h_));
+        }
+
         // preprocess
-        cv::Mat pr_img = static_resize(frame);
         // locked memory holder should be alive all time while access to its buffer happens
-        blobFromImage(pr_img, this->blob_.data());
+        write_input(frame, format, *input_tensor);
 
         // do inference
         /* Running the request synchronously */
-        this->infer_request_.set_input_tensor(
-            ov::Tensor{ov::element::f32, this->input_shape_, reinterpret_cast<float *>(this->blob_.data())});
+        this->infer_request_.set_input_tensor(*input_tensor);
         infer_request_.infer();
 
+        decode_output(this->infer_request_.get_output_tensor(), size, objects, nullptr);
+    }
+
+    std::vector<std::vector<Object>> YoloXOpenVINO::inference_batch(const std::vector<cv::Mat>& frames, const PixelFormat format)
+    {
+        const size_t batch = frames.size();
+        // with a dynamic input size every frame may get its own shape
+        if (this->dynamic_input())
+        {
+            return AbcYoloX::inference_batch(frames, format);
+        }
+        if (!this->async_requests_.empty() && batch > 1)
+        {
+            return inference_async(frames, format);
+        }
+        if (!this->dynamic_batch_ || batch <= 1 ||
+            this->input_type_ != ov::element::f32 || this->output_type_ != ov::element::f32 ||
+            this->output_format_ == OutputFormat::NMS)
+        {
+            return AbcYoloX::inference_batch(frames, format);
+        }
+
+        // preprocess: one N x 3 x H x W blob
+        ov::Shape batch_shape = this->input_shape_;
+        batch_shape[0] = batch;
+        const size_t input_size = ov::shape_size(this->input_shape_);
+        this->batch_blob_.resize(batch * input_size);
+        for (size_t b = 0; b < batch; ++b)
+        {
+            blobFromImage_letterbox(frames[b], format, this->batch_blob_.data() + b * input_size);
+        }
+
+        // do inference
+        this->infer_request_.set_input_tensor(
+            ov::Tensor{ov::element::f32, batch_shape, this->batch_blob_.data()});
+        this->infer_request_.infer();
+
         const auto &output_tensor = this->infer_request_.get_output_tensor();
         const float* net_pred = reinterpret_cast<float *>(output_tensor.data());
 
-        const float scale = std::min(
-            static_cast<float>(this->input_w_) / static_cast<float>(frame.cols),
-            static_cast<float>(this->input_h_) / static_cast<float>(frame.rows)
-        );
+        std::vector<std::vector<Object>> objects;
+        decode_outputs_batch(net_pred, output_tensor.get_size() / batch, frames, format, objects);
+        return objects;
+    }
+
+    std::vector<std::vector<Object>> YoloXOpenVINO::inference_async(const std::vector<cv::Mat>& frames, const PixelFormat format)
+    {
+        const size_t batch = frames.size();
+        const size_t num_requests = this->async_requests_.size();
+        std::vector<std::vector<Object>> objects(batch);
+        std::vector<std::exception_ptr> errors(num_requests);
+        // one scratch per frame: a request slot decodes several frames
+        this->batch_scratch_.resize(batch);
 
-        std::vector<Object> objects;
-        decode_outputs(net_pred, this->grid_strides_, objects, this->bbox_conf_thresh_, scale, frame.cols, frame.rows);
+        // Frames go round-robin over the request pool. Preprocessing of a frame
+        // overlaps inference of the frames already in flight, and each request
+        // decodes its own output from the completion callback.
+        for (size_t i = 0; i < batch; ++i)
+        {
+            const size_t slot = i % num_requests;
+            ov::InferRequest &request = this->async_requests_[slot];
+            request.wait();
+            if (errors[slot])
+            {
+                break;
+            }
+
+            ov::Tensor input_tensor = request.get_input_tensor();
+            write_input(frames[i], format, input_tensor);
+
+            request.set_callback([this, &request, &frames, &objects, &errors, format, i, slot](std::exception_ptr error)
+            {
+                if (error)
+                {
+                    errors[slot] = error;
+                    return;
+                }
+                try
+                {
+                    decode_output(request.get_output_tensor(), image_size(frames[i], format), objects[i],
+                                  &this->batch_scratch_[i]);
+                }
+                catch (...)
+                {
+                    errors[slot] = std::current_exception();
+                }
+            });
+            request.start_async();
+        }
+
+        for (auto &request : this->async_requests_)
+        {
+            request.wait();
+        }
+        if (this->profiling_)
+        {
+            // inference and decode overlap here: infer runs from the last preprocess
+            // to the last completion, decode / nms add up the callbacks' own times
+            finish_stage_times(std::chrono::steady_clock::now(), this->batch_scratch_.data(), batch);
+        }
+        for (const auto &error : errors)
+        {
+            if (error)
+            {
+                std::rethrow_exception(error);
+            }
+        }
         return objects;
     }
 }
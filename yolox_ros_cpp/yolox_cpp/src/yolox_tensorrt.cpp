@@ -63,11 +63,14 @@ namespace yolox_cpp
         // In order to bind the buffers, we need to know the names of the input and output tensors.
         // Note that indices are guaranteed to be less than IEngine::getNbBindings()
         assert(this->engine_->getTensorDataType(input_name) == nvinfer1::DataType::kFLOAT);
-        assert(this->engine_->getTensorDataType(output_name) == nvinfer1::DataType::kFLOAT);
+        const auto output_type = this->engine_->getTensorDataType(output_name);
+        assert(output_type == nvinfer1::DataType::kFLOAT || output_type == nvinfer1::DataType::kHALF);
+        this->output_half_ = output_type == nvinfer1::DataType::kHALF;
+        this->output_element_size_ = this->output_half_ ? sizeof(uint16_t) : sizeof(float);
 
         // Create GPU buffers on device
         CHECK(cudaMalloc(&this->inference_buffers_[this->inputIndex_], 3 * this->input_h_ * this->input_w_ * sizeof(float)));
-        CHECK(cudaMalloc(&this->inference_buffers_[this->outputIndex_], this->output_size_ * sizeof(float)));
+        CHECK(cudaMalloc(&this->inference_buffers_[this->outputIndex_], this->output_size_ * this->output_element_size_));
 
         assert(this->context_->setInputShape(input_name, input_dims));
         assert(this->context_->allInputDimensionsSpecified());
@@ -75,59 +78,66 @@ namespace yolox_cpp
         assert(this->context_->setInputTensorAddress(input_name, this->inference_buffers_[this->inputIndex_]));
         assert(this->context_->setOutputTensorAddress(output_name, this->inference_buffers_[this->outputIndex_]));
 
-        // Prepare GridAndStrides
+        // Create stream, reused by every inference
+        CHECK(cudaStreamCreate(&this->stream_));
+
+        // Prepare anchor table
         if (this->p6_)
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_p6_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_p6_, this->anchor_table_);
         }
         else
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_, this->anchor_table_);
         }
     }
 
     YoloXTensorRT::~YoloXTensorRT()
     {
+        CHECK(cudaStreamDestroy(this->stream_));
         CHECK(cudaFree(inference_buffers_[this->inputIndex_]));
         CHECK(cudaFree(inference_buffers_[this->outputIndex_]));
     }
 
-    std::vector<Object> YoloXTensorRT::inference(const cv::Mat &frame)
+    void YoloXTensorRT::inference(const cv::Mat &frame, const PixelFormat format, std::vector<Object> &objects)
     {
         // preprocess
-        auto pr_img = static_resize(frame);
-        blobFromImage(pr_img, input_blob_.data());
+        blobFromImage_letterbox(frame, format, input_blob_.data());
 
         // inference
         this->doInference(input_blob_.data(), output_blob_.data());
 
         // postprocess
+        const cv::Size size = image_size(frame, format);
         const float scale = std::min(
-            static_cast<float>(this->input_w_) / static_cast<float>(frame.cols),
-            static_cast<float>(this->input_h_) / static_cast<float>(frame.rows)
+            static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+            static_cast<float>(this->input_h_) / static_cast<float>(size.height)
         );
 
-        std::vector<Object> objects;
-        decode_outputs(
-            output_blob_.data(), this->grid_strides_, objects,
-            this->bbox_conf_thresh_, scale, frame.cols, frame.rows);
-
-        return objects;
+        if (this->output_half_)
+        {
+            // output_blob_ holds output_size_ fp16 values
+            decode_outputs(
+                reinterpret_cast<const Float16 *>(output_blob_.data()), Quantization(), this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+        }
+        else
+        {
+            decode_outputs(
+                output_blob_.data(), this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+        }
     }
 
     void YoloXTensorRT::doInference(const float *input, float *output)
     {
-        // Create stream
-        cudaStream_t stream;
-        CHECK(cudaStreamCreate(&stream));
-
         // DMA input batch data to device, infer on the batch asynchronously, and DMA output back to host
         CHECK(
             cudaMemcpyAsync(
                 this->inference_buffers_[this->inputIndex_],
                 input,
                 3 * this->input_h_ * this->input_w_ * sizeof(float),
-                cudaMemcpyHostToDevice, stream));
+                cudaMemcpyHostToDevice, this->stream_));
 
         bool success = context_->executeV2(this->inference_buffers_);
         if (!success)
@@ -137,13 +147,10 @@ namespace yolox_cpp
             cudaMemcpyAsync(
                 output,
                 this->inference_buffers_[this->outputIndex_],
-                this->output_size_ * sizeof(float),
-                cudaMemcpyDeviceToHost, stream));
-
-        CHECK(cudaStreamSynchronize(stream));
+                this->output_size_ * this->output_element_size_,
+                cudaMemcpyDeviceToHost, this->stream_));
 
-        // Release stream
-        CHECK(cudaStreamDestroy(stream));
+        CHECK(cudaStreamSynchronize(this->stream_));
     }
 
 } // namespace yolox_cpp
@@ -2,6 +2,21 @@
 
 namespace yolox_cpp
 {
+    namespace
+    {
+        // A uint8 / int8 tensor without quantization parameters (scale 0) holds
+        // plain values, e.g. raw pixels: read it as scale 1, zero point 0.
+        Quantization tensor_quantization(const TfLiteTensor *tensor)
+        {
+            Quantization quant;
+            if (tensor->params.scale != 0.0f)
+            {
+                quant.scale = tensor->params.scale;
+                quant.zero_point = tensor->params.zero_point;
+            }
+            return quant;
+        }
+    }
 
     YoloXTflite::YoloXTflite(const file_name_t &path_to_model, int num_threads,
                              float nms_th, float conf_th, const std::string &model_version,
@@ -89,9 +104,11 @@ namespace yolox_cpp
             }
 
             std::cout << " shape:" << std::endl;
-            if (tensor->type == kTfLiteUInt8)
+            this->input_type_ = tensor->type;
+            if (tensor->type == kTfLiteUInt8 || tensor->type == kTfLiteInt8)
             {
                 this->input_size_ = sizeof(uint8_t);
+                this->input_quant_ = tensor_quantization(tensor);
             }
             else
             {
@@ -112,9 +129,15 @@ namespace yolox_cpp
             std::cout << "output:" << std::endl;
             std::cout << " name: " << tensor->name << std::endl;
             std::cout << " shape:" << std::endl;
-            if (tensor->type == kTfLiteUInt8)
+            this->output_type_ = tensor->type;
+            if (tensor->type == kTfLiteUInt8 || tensor->type == kTfLiteInt8)
             {
                 this->output_size_ = sizeof(uint8_t);
+                this->output_quant_ = tensor_quantization(tensor);
+            }
+            else if (tensor->type == kTfLiteFloat16)
+            {
+                this->output_size_ = sizeof(uint16_t);
             }
             else
             {
@@ -128,33 +151,58 @@ namespace yolox_cpp
             std::cout << " tensor_type: " << tensor->type << std::endl;
         }
 
-        // Prepare GridAndStrides
+        // Prepare anchor table
         if(this->p6_)
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_p6_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_p6_, this->anchor_table_);
         }
         else
         {
-            generate_grids_and_stride(this->input_w_, this->input_h_, this->strides_, this->grid_strides_);
+            generate_anchor_table(this->input_w_, this->input_h_, this->strides_, this->anchor_table_);
         }
     }
     YoloXTflite::~YoloXTflite()
     {
         TfLiteXNNPackDelegateDelete(this->delegate_);
     }
-    std::vector<Object> YoloXTflite::inference(const cv::Mat &frame)
+    void YoloXTflite::check_nms_output() const
+    {
+        const TfLiteTensor *tensor = this->interpreter_->output_tensor(0);
+        const int rank = tensor->dims->size;
+        if (tensor->type != kTfLiteFloat32 || rank < 2 || tensor->dims->data[rank - 1] != 7)
+        {
+            std::string msg = "output " + std::string(tensor->name) + " (type " + std::to_string(tensor->type) +
+                              ", rank " + std::to_string(rank) + ") is not an in-graph NMS output, expected float32 [N, 7]";
+            throw std::runtime_error(msg.c_str());
+        }
+    }
+    template <typename T>
+    void YoloXTflite::write_input(const cv::Mat &frame, const PixelFormat format, T *input_blob)
     {
-        // preprocess
-        cv::Mat pr_img = static_resize(frame);
-
-        float *input_blob = this->interpreter_->typed_input_tensor<float>(0);
         if (this->is_nchw_ == true)
         {
-            blobFromImage(pr_img, input_blob);
+            blobFromImage_letterbox(frame, format, input_blob, this->input_quant_);
         }
         else
         {
-            blobFromImage_nhwc(pr_img, input_blob);
+            blobFromImage_letterbox_nhwc(frame, format, input_blob, this->input_quant_);
+        }
+    }
+
+    void YoloXTflite::inference(const cv::Mat &frame, const PixelFormat format, std::vector<Object> &objects)
+    {
+        // preprocess, quantized inputs are written directly as uint8 / int8
+        switch (this->input_type_)
+        {
+        case kTfLiteUInt8:
+            write_input(frame, format, this->interpreter_->typed_input_tensor<uint8_t>(0));
+            break;
+        case kTfLiteInt8:
+            write_input(frame, format, this->interpreter_->typed_input_tensor<int8_t>(0));
+            break;
+        default:
+            write_input(frame, format, this->interpreter_->typed_input_tensor<float>(0));
+            break;
         }
 
         // inference
@@ -162,21 +210,57 @@ namespace yolox_cpp
         if (ret != TfLiteStatus::kTfLiteOk)
         {
             std::cerr << "Failed to invoke." << std::endl;
-            return std::vector<Object>();
+            objects.clear();
+            return;
         }
 
-        // postprocess
+        // postprocess, quantized and fp16 outputs are converted inside the decoder
+        const cv::Size size = image_size(frame, format);
         const float scale = std::min(
-            static_cast<float>(this->input_w_) / static_cast<float>(frame.cols),
-            static_cast<float>(this->input_h_) / static_cast<float>(frame.rows)
+            static_cast<float>(this->input_w_) / static_cast<float>(size.width),
+            static_cast<float>(this->input_h_) / static_cast<float>(size.height)
         );
-        std::vector<Object> objects;
-        decode_outputs(
-            this->interpreter_->typed_output_tensor<float>(0),
-            this->grid_strides_, objects,
-            this->bbox_conf_thresh_, scale, frame.cols, frame.rows);
-
-        return objects;
+        if (this->output_format_ == OutputFormat::NMS)
+        {
+            // N x 7 float detections (checked by set_output_format), N is known after Invoke()
+            const TfLiteTensor *tensor = this->interpreter_->output_tensor(0);
+            size_t num_values = 1;
+            for (int i = 0; i < tensor->dims->size; i++)
+            {
+                num_values *= tensor->dims->data[i];
+            }
+            decode_detections(
+                this->interpreter_->typed_output_tensor<float>(0), num_values / 7, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+            return;
+        }
+        switch (this->output_type_)
+        {
+        case kTfLiteUInt8:
+            decode_outputs(
+                this->interpreter_->typed_output_tensor<uint8_t>(0), this->output_quant_,
+                this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+            break;
+        case kTfLiteInt8:
+            decode_outputs(
+                this->interpreter_->typed_output_tensor<int8_t>(0), this->output_quant_,
+                this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+            break;
+        case kTfLiteFloat16:
+            decode_outputs(
+                reinterpret_cast<const Float16 *>(this->interpreter_->typed_output_tensor<TfLiteFloat16>(0)), Quantization(),
+                this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+            break;
+        default:
+            decode_outputs(
+                this->interpreter_->typed_output_tensor<float>(0),
+                this->anchor_table_, objects,
+                this->bbox_conf_thresh_, scale, size.width, size.height);
+            break;
+        }
     }
 
 } // namespace yolox_cpp
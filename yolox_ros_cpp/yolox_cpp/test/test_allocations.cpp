@@ -0,0 +1,227 @@
+// Steady-state inference of the null backend makes no heap allocation.
+//
+// malloc and friends are replaced for the whole process, so operator new as well as
+// cv::fastMalloc (posix_memalign / memalign) and anything inside OpenCV are counted.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "yolox_cpp/yolox_null.hpp"
+
+#if defined(__GLIBC__)
+#define YOLOX_TEST_COUNT_ALLOCATIONS 1
+#endif
+
+namespace
+{
+    std::atomic<bool> counting{false};
+    std::atomic<uint64_t> allocation_count{0};
+
+    inline void count_allocation()
+    {
+        if (counting.load(std::memory_order_relaxed))
+        {
+            allocation_count.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+#ifdef YOLOX_TEST_COUNT_ALLOCATIONS
+// glibc's own allocator, behind the replacements below
+extern "C"
+{
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t n, size_t size);
+    void *__libc_realloc(void *ptr, size_t size);
+    void *__libc_memalign(size_t alignment, size_t size);
+    void __libc_free(void *ptr);
+
+    void *malloc(size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_malloc(size);
+    }
+
+    void *calloc(size_t n, size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_calloc(n, size);
+    }
+
+    void *realloc(void *ptr, size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_realloc(ptr, size);
+    }
+
+    void *memalign(size_t alignment, size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    void *aligned_alloc(size_t alignment, size_t size) noexcept
+    {
+        count_allocation();
+        return __libc_memalign(alignment, size);
+    }
+
+    int posix_memalign(void **ptr, size_t alignment, size_t size) noexcept
+    {
+        if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+        {
+            return EINVAL;
+        }
+        count_allocation();
+        void *p = __libc_memalign(alignment, size);
+        if (p == nullptr)
+        {
+            return ENOMEM;
+        }
+        *ptr = p;
+        return 0;
+    }
+
+    void free(void *ptr) noexcept
+    {
+        __libc_free(ptr);
+    }
+}
+#endif
+
+namespace
+{
+    using yolox_cpp::NmsMethod;
+    using yolox_cpp::Object;
+    using yolox_cpp::ObjectArrays;
+    using yolox_cpp::PixelFormat;
+
+    const int warmup_frames = 3;
+    const int measured_frames = 20;
+
+    cv::Mat random_frame(const int w, const int h)
+    {
+        std::mt19937 rng(7);
+        std::uniform_int_distribution<int> pixel(0, 255);
+        cv::Mat img(h, w, CV_8UC3);
+        for (int y = 0; y < h; ++y)
+        {
+            uint8_t *row = img.ptr<uint8_t>(y);
+            for (int x = 0; x < w * 3; ++x)
+            {
+                row[x] = static_cast<uint8_t>(pixel(rng));
+            }
+        }
+        return img;
+    }
+
+    // Allocations made by f(), called from this thread only
+    template <typename F>
+    uint64_t count_allocations(F &&f)
+    {
+        allocation_count.store(0);
+        counting.store(true);
+        f();
+        counting.store(false);
+        return allocation_count.load();
+    }
+
+    class AllocationTest : public ::testing::Test
+    {
+    protected:
+        void SetUp() override
+        {
+#ifndef YOLOX_TEST_COUNT_ALLOCATIONS
+            GTEST_SKIP() << "allocation counting needs glibc";
+#endif
+            // OpenCV's thread pool allocates a job for every parallel_for_ it hands to
+            // worker threads; run the loop bodies on the calling thread instead.
+            this->num_threads_ = cv::getNumThreads();
+            cv::setNumThreads(1);
+        }
+
+        void TearDown() override
+        {
+            if (this->num_threads_ >= 0)
+            {
+                cv::setNumThreads(this->num_threads_);
+            }
+        }
+
+        int num_threads_ = -1;
+    };
+
+    TEST_F(AllocationTest, CountsOpenCvAndOperatorNew)
+    {
+        // the hooks see every allocator this test relies on
+        EXPECT_EQ(1u, count_allocations([]
+                                        {
+                                            // volatile: the compiler may drop a new / delete pair
+                                            int *volatile p = new int(1);
+                                            delete p; }));
+        EXPECT_GE(count_allocations([]
+                                    { cv::fastFree(cv::fastMalloc(100)); }),
+                  1u);
+        EXPECT_GE(count_allocations([]
+                                    { cv::Mat m(64, 64, CV_8UC3); }),
+                  1u);
+    }
+
+    TEST_F(AllocationTest, InferenceDoesNotAllocate)
+    {
+        const cv::Mat frame = random_frame(1280, 720);
+        for (const NmsMethod method : {NmsMethod::REFERENCE, NmsMethod::SOA, NmsMethod::GRID})
+        {
+            for (const bool class_agnostic : {true, false})
+            {
+                yolox_cpp::YoloXNull yolox("", 640, 640, 0.0, 0.01f);
+                yolox.set_nms_method(method);
+                yolox.set_class_agnostic_nms(class_agnostic);
+                std::vector<Object> objects;
+                for (int i = 0; i < warmup_frames; ++i)
+                {
+                    yolox.inference(frame, objects);
+                }
+                ASSERT_FALSE(objects.empty());
+
+                const uint64_t allocations = count_allocations([&]
+                {
+                    for (int i = 0; i < measured_frames; ++i)
+                    {
+                        yolox.inference(frame, objects);
+                    }
+                });
+                EXPECT_EQ(0u, allocations) << "nms method " << static_cast<int>(method)
+                                           << (class_agnostic ? ", class-agnostic" : ", class-aware");
+            }
+        }
+    }
+
+    TEST_F(AllocationTest, OtherPixelFormatsAndArraysDoNotAllocate)
+    {
+        const cv::Mat frame = random_frame(640, 480);
+        yolox_cpp::YoloXNull yolox("", 416, 416, 0.0, 0.01f);
+        ObjectArrays arrays;
+        for (int i = 0; i < warmup_frames; ++i)
+        {
+            yolox.inference(frame, PixelFormat::RGB, arrays);
+        }
+        ASSERT_GT(arrays.size(), 0u);
+
+        const uint64_t allocations = count_allocations([&]
+        {
+            for (int i = 0; i < measured_frames; ++i)
+            {
+                yolox.inference(frame, PixelFormat::RGB, arrays);
+            }
+        });
+        EXPECT_EQ(0u, allocations);
+    }
+}
@@ -0,0 +1,294 @@
+// Fused letterbox (blobFromImage_letterbox*) against cv::resize + padding + normalization.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <opencv2/core.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include "yolox_cpp/core.hpp"
+
+namespace
+{
+    using yolox_cpp::Object;
+    using yolox_cpp::PixelFormat;
+    using yolox_cpp::Quantization;
+
+    // Exposes the letterbox of a model input of input_w x input_h
+    class LetterboxProbe : public yolox_cpp::AbcYoloX
+    {
+    public:
+        LetterboxProbe(const int input_w, const int input_h, const std::string &model_version)
+            : AbcYoloX(0.45, 0.3, model_version)
+        {
+            this->input_w_ = input_w;
+            this->input_h_ = input_h;
+        }
+
+        void inference(const cv::Mat &, PixelFormat, std::vector<Object> &objects) override
+        {
+            objects.clear();
+        }
+
+        using AbcYoloX::blobFromImage_letterbox;
+        using AbcYoloX::blobFromImage_letterbox_nhwc;
+
+        int input_w() const
+        {
+            return this->input_w_;
+        }
+
+        int input_h() const
+        {
+            return this->input_h_;
+        }
+
+        const float *input_scale() const
+        {
+            return this->input_scale_;
+        }
+
+        const float *input_bias() const
+        {
+            return this->input_bias_;
+        }
+    };
+
+    cv::Mat random_frame(const int w, const int h, const unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_int_distribution<int> pixel(0, 255);
+        cv::Mat img(h, w, CV_8UC3);
+        for (int y = 0; y < h; ++y)
+        {
+            uint8_t *row = img.ptr<uint8_t>(y);
+            for (int x = 0; x < w * 3; ++x)
+            {
+                row[x] = static_cast<uint8_t>(pixel(rng));
+            }
+        }
+        return img;
+    }
+
+    // The unfused pipeline: cv::resize into the top-left corner of a 114-filled input
+    cv::Mat reference_letterbox(const cv::Mat &img, const int input_w, const int input_h)
+    {
+        const float r = std::min(static_cast<float>(input_w) / static_cast<float>(img.cols),
+                                 static_cast<float>(input_h) / static_cast<float>(img.rows));
+        const int unpad_w = r * img.cols;
+        const int unpad_h = r * img.rows;
+        cv::Mat padded(input_h, input_w, CV_8UC3, cv::Scalar(114, 114, 114));
+        cv::Mat resized;
+        cv::resize(img, resized, cv::Size(unpad_w, unpad_h));
+        cv::Mat roi = padded(cv::Rect(0, 0, unpad_w, unpad_h));
+        resized.copyTo(roi);
+        return padded;
+    }
+
+    // value of channel c of pixel (x, y) in a blob of the given layout
+    template <typename T>
+    T blob_at(const std::vector<T> &blob, const int input_w, const int input_h, const bool nchw,
+              const int x, const int y, const int c)
+    {
+        const size_t plane = static_cast<size_t>(input_w) * input_h;
+        const size_t pixel = static_cast<size_t>(y) * input_w + x;
+        return nchw ? blob[c * plane + pixel] : blob[pixel * 3 + c];
+    }
+
+    // The fused letterbox samples in float, cv::resize rounds each pixel to uint8
+    // (in fixed point), so they may differ by one pixel level (levels).
+    void expect_float_blob(LetterboxProbe &probe, const cv::Mat &frame, const PixelFormat format,
+                           const cv::Mat &reference, const bool nchw, const std::string &what,
+                           const float levels = 1.0f)
+    {
+        const int w = probe.input_w();
+        const int h = probe.input_h();
+        std::vector<float> blob(static_cast<size_t>(w) * h * 3, -1000.0f);
+        if (nchw)
+        {
+            probe.blobFromImage_letterbox(frame, format, blob.data());
+        }
+        else
+        {
+            probe.blobFromImage_letterbox_nhwc(frame, format, blob.data());
+        }
+        const float *scale = probe.input_scale();
+        const float *bias = probe.input_bias();
+        int mismatches = 0;
+        for (int y = 0; y < h && mismatches < 10; ++y)
+        {
+            const uint8_t *ref = reference.ptr<uint8_t>(y);
+            for (int x = 0; x < w && mismatches < 10; ++x)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float expected = ref[x * 3 + c] * scale[c] + bias[c];
+                    const float actual = blob_at(blob, w, h, nchw, x, y, c);
+                    if (std::fabs(expected - actual) > levels * scale[c] + 1e-4f)
+                    {
+                        ADD_FAILURE() << what << " at (" << x << ", " << y << ", " << c << "): expected "
+                                      << expected << ", got " << actual;
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void expect_quantized_blob(LetterboxProbe &probe, const cv::Mat &frame, const cv::Mat &reference,
+                               const Quantization &quant, const std::string &what)
+    {
+        const int w = probe.input_w();
+        const int h = probe.input_h();
+        std::vector<T> blob(static_cast<size_t>(w) * h * 3);
+        probe.blobFromImage_letterbox(frame, PixelFormat::BGR, blob.data(), quant);
+        int mismatches = 0;
+        for (int y = 0; y < h && mismatches < 10; ++y)
+        {
+            const uint8_t *ref = reference.ptr<uint8_t>(y);
+            for (int x = 0; x < w && mismatches < 10; ++x)
+            {
+                for (int c = 0; c < 3; ++c)
+                {
+                    const float q = std::nearbyint(ref[x * 3 + c] / quant.scale) + quant.zero_point;
+                    const float lo = std::numeric_limits<T>::min();
+                    const float hi = std::numeric_limits<T>::max();
+                    const int expected = static_cast<int>(std::min(std::max(q, lo), hi));
+                    const int actual = blob_at(blob, w, h, true, x, y, c);
+                    if (std::abs(expected - actual) > 1)
+                    {
+                        ADD_FAILURE() << what << " at (" << x << ", " << y << ", " << c << "): expected "
+                                      << expected << ", got " << actual;
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+    }
+
+    struct Case
+    {
+        int frame_w;
+        int frame_h;
+        int input_w;
+        int input_h;
+    };
+
+    // same size (no resampling), down, up, odd sizes, tall frames and non-square inputs
+    const std::vector<Case> cases = {
+        {640, 640, 640, 640},
+        {1280, 720, 640, 640},
+        {320, 240, 640, 640},
+        {641, 479, 416, 416},
+        {100, 700, 640, 640},
+        {1920, 1080, 640, 384},
+        {640, 384, 640, 384},
+    };
+
+    std::string describe(const Case &c, const std::string &isa)
+    {
+        return std::to_string(c.frame_w) + "x" + std::to_string(c.frame_h) + " -> " +
+               std::to_string(c.input_w) + "x" + std::to_string(c.input_h) + " (" + isa + ")";
+    }
+
+    class LetterboxTest : public ::testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            yolox_cpp::simd::set_isa(yolox_cpp::simd::available_isas().front());
+        }
+    };
+
+    TEST_F(LetterboxTest, MatchesResizeAndPadding)
+    {
+        for (const char *model_version : {"0.1.1rc0", "0.1.0"})
+        {
+            for (const Case &c : cases)
+            {
+                const cv::Mat frame = random_frame(c.frame_w, c.frame_h, c.frame_w * 31 + c.frame_h);
+                const cv::Mat reference = reference_letterbox(frame, c.input_w, c.input_h);
+                for (const std::string &isa : yolox_cpp::simd::available_isas())
+                {
+                    ASSERT_TRUE(yolox_cpp::simd::set_isa(isa));
+                    LetterboxProbe probe(c.input_w, c.input_h, model_version);
+                    const std::string what = describe(c, isa) + " " + model_version;
+                    expect_float_blob(probe, frame, PixelFormat::BGR, reference, true, what + " nchw");
+                    expect_float_blob(probe, frame, PixelFormat::BGR, reference, false, what + " nhwc");
+                }
+            }
+        }
+    }
+
+    TEST_F(LetterboxTest, RgbFrameMatchesBgrReference)
+    {
+        for (const Case &c : cases)
+        {
+            const cv::Mat frame = random_frame(c.frame_w, c.frame_h, c.frame_h * 17 + c.frame_w);
+            cv::Mat rgb(frame.rows, frame.cols, CV_8UC3);
+            for (int y = 0; y < frame.rows; ++y)
+            {
+                const uint8_t *src = frame.ptr<uint8_t>(y);
+                uint8_t *dst = rgb.ptr<uint8_t>(y);
+                for (int x = 0; x < frame.cols; ++x)
+                {
+                    dst[x * 3 + 0] = src[x * 3 + 2];
+                    dst[x * 3 + 1] = src[x * 3 + 1];
+                    dst[x * 3 + 2] = src[x * 3 + 0];
+                }
+            }
+            LetterboxProbe probe(c.input_w, c.input_h, "0.1.1rc0");
+            expect_float_blob(probe, rgb, PixelFormat::RGB, reference_letterbox(frame, c.input_w, c.input_h), true,
+                              describe(c, "rgb"));
+        }
+    }
+
+    TEST_F(LetterboxTest, Nv12FrameMatchesConvertedReference)
+    {
+        for (const Case &c : cases)
+        {
+            if (c.frame_w % 2 != 0 || c.frame_h % 2 != 0)
+            {
+                continue;
+            }
+            // OpenCV's NV12 layout: frame_h rows of Y, then frame_h / 2 rows of interleaved UV
+            const cv::Mat packed = random_frame(c.frame_w / 2, c.frame_h, c.frame_w * 7 + c.frame_h);
+            cv::Mat nv12(c.frame_h * 3 / 2, c.frame_w, CV_8UC1);
+            for (int y = 0; y < nv12.rows; ++y)
+            {
+                const uint8_t *src = packed.ptr<uint8_t>(y % c.frame_h);
+                std::copy(src, src + c.frame_w, nv12.ptr<uint8_t>(y));
+            }
+            cv::Mat bgr;
+            cv::cvtColor(nv12, bgr, cv::COLOR_YUV2BGR_NV12);
+            ASSERT_EQ(c.frame_h, bgr.rows);
+            LetterboxProbe probe(c.input_w, c.input_h, "0.1.1rc0");
+            // the reference rounds twice (color conversion, then resize)
+            expect_float_blob(probe, nv12, PixelFormat::NV12, reference_letterbox(bgr, c.input_w, c.input_h), true,
+                              describe(c, "nv12"), 2.0f);
+        }
+    }
+
+    TEST_F(LetterboxTest, QuantizedMatchesResizeAndPadding)
+    {
+        for (const Case &c : cases)
+        {
+            const cv::Mat frame = random_frame(c.frame_w, c.frame_h, c.frame_w + c.frame_h);
+            const cv::Mat reference = reference_letterbox(frame, c.input_w, c.input_h);
+            LetterboxProbe probe(c.input_w, c.input_h, "0.1.1rc0");
+            Quantization u8;
+            expect_quantized_blob<uint8_t>(probe, frame, reference, u8, describe(c, "uint8"));
+            Quantization s8;
+            s8.scale = 2.0f;
+            s8.zero_point = -128;
+            expect_quantized_blob<int8_t>(probe, frame, reference, s8, describe(c, "int8"));
+        }
+    }
+}
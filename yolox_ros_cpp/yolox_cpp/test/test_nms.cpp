@@ -0,0 +1,213 @@
+// SOA / GRID NMS engines against the REFERENCE engine.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "yolox_cpp/core.hpp"
+
+namespace
+{
+    using yolox_cpp::ClassBuckets;
+    using yolox_cpp::NmsMethod;
+    using yolox_cpp::NmsScratch;
+    using yolox_cpp::Object;
+    using yolox_cpp::PixelFormat;
+
+    // Exposes the NMS engines of a model input of input_w x input_h
+    class NmsProbe : public yolox_cpp::AbcYoloX
+    {
+    public:
+        NmsProbe(const int input_w, const int input_h, const int num_classes)
+            : AbcYoloX(0.45, 0.3, "0.1.1rc0", num_classes)
+        {
+            this->input_w_ = input_w;
+            this->input_h_ = input_h;
+        }
+
+        void inference(const cv::Mat &, PixelFormat, std::vector<Object> &objects) override
+        {
+            objects.clear();
+        }
+
+        using AbcYoloX::batched_nms;
+        using AbcYoloX::run_nms;
+    };
+
+    const std::vector<NmsMethod> methods = {NmsMethod::SOA, NmsMethod::GRID};
+
+    std::string method_name(const NmsMethod method)
+    {
+        return method == NmsMethod::SOA ? "soa" : "grid";
+    }
+
+    // Clusters of jittered boxes (so that many overlap around the threshold), sorted by
+    // descending score. Some boxes stick out of the model input to cover the grid clamp.
+    std::vector<Object> random_proposals(const size_t n, const int input_w, const int input_h,
+                                         const int num_classes, const unsigned seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> center_x(-20.0f, input_w + 20.0f);
+        std::uniform_real_distribution<float> center_y(-20.0f, input_h + 20.0f);
+        std::uniform_real_distribution<float> size(4.0f, 200.0f);
+        std::normal_distribution<float> jitter(0.0f, 0.08f);
+        std::uniform_real_distribution<float> score(0.3f, 1.0f);
+        std::uniform_int_distribution<int> label(0, num_classes - 1);
+        std::uniform_int_distribution<int> cluster_size(1, 12);
+
+        std::vector<Object> proposals;
+        while (proposals.size() < n)
+        {
+            const float cx = center_x(rng);
+            const float cy = center_y(rng);
+            const float w = size(rng);
+            const float h = size(rng);
+            const int cluster_label = label(rng);
+            for (int k = cluster_size(rng); k > 0 && proposals.size() < n; --k)
+            {
+                Object obj;
+                const float bw = w * (1.0f + jitter(rng));
+                const float bh = h * (1.0f + jitter(rng));
+                obj.rect.x = cx + w * jitter(rng) - bw / 2;
+                obj.rect.y = cy + h * jitter(rng) - bh / 2;
+                obj.rect.width = std::max(bw, 1.0f);
+                obj.rect.height = std::max(bh, 1.0f);
+                obj.prob = score(rng);
+                // mostly the cluster's class, so class-aware NMS keeps some overlapping boxes
+                obj.label = k % 4 == 0 ? label(rng) : cluster_label;
+                proposals.push_back(obj);
+            }
+        }
+        std::stable_sort(proposals.begin(), proposals.end(),
+                         [](const Object &a, const Object &b)
+                         { return a.prob > b.prob; });
+        return proposals;
+    }
+
+    const std::vector<size_t> counts = {0, 1, 2, 17, 100, 511, 512, 2000};
+
+    class NmsTest : public ::testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            yolox_cpp::simd::set_isa(yolox_cpp::simd::available_isas().front());
+        }
+    };
+
+    TEST_F(NmsTest, ClassAgnosticMatchesReference)
+    {
+        NmsProbe probe(640, 384, 80);
+        for (const size_t n : counts)
+        {
+            const std::vector<Object> proposals = random_proposals(n, 640, 384, 80, n + 1);
+            for (const float thresh : {0.3f, 0.45f, 0.65f})
+            {
+                NmsScratch scratch;
+                std::vector<int> expected;
+                probe.set_nms_method(NmsMethod::REFERENCE);
+                probe.run_nms(proposals, expected, thresh, scratch);
+                if (n > 0)
+                {
+                    ASSERT_FALSE(expected.empty());
+                    EXPECT_EQ(0, expected.front());
+                }
+
+                for (const NmsMethod method : methods)
+                {
+                    probe.set_nms_method(method);
+                    for (const std::string &isa : yolox_cpp::simd::available_isas())
+                    {
+                        ASSERT_TRUE(yolox_cpp::simd::set_isa(isa));
+                        // scratch left over from the previous run must not change the result
+                        std::vector<int> actual = {-1};
+                        probe.run_nms(proposals, actual, thresh, scratch);
+                        EXPECT_EQ(expected, actual) << method_name(method) << " (" << isa << ") n=" << n
+                                                    << " thresh=" << thresh;
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_F(NmsTest, ClassAwareMatchesReference)
+    {
+        const int num_classes = 5;
+        NmsProbe probe(416, 416, num_classes);
+        for (const size_t n : counts)
+        {
+            const std::vector<Object> proposals = random_proposals(n, 416, 416, num_classes, n * 7 + 3);
+
+            // per-class reference, merged back in score order
+            std::vector<int> expected;
+            probe.set_nms_method(NmsMethod::REFERENCE);
+            for (int c = 0; c < num_classes; ++c)
+            {
+                std::vector<Object> of_class;
+                std::vector<int> index;
+                for (size_t i = 0; i < proposals.size(); ++i)
+                {
+                    if (proposals[i].label == c)
+                    {
+                        of_class.push_back(proposals[i]);
+                        index.push_back(i);
+                    }
+                }
+                NmsScratch scratch;
+                std::vector<int> picked;
+                probe.run_nms(of_class, picked, 0.45f, scratch);
+                for (const int j : picked)
+                {
+                    expected.push_back(index[j]);
+                }
+            }
+            std::sort(expected.begin(), expected.end());
+
+            ClassBuckets buckets;
+            std::vector<int> actual;
+            probe.batched_nms(proposals, actual, 0.45f, buckets);
+            EXPECT_EQ(expected, actual) << "reference n=" << n;
+
+            for (const NmsMethod method : methods)
+            {
+                probe.set_nms_method(method);
+                for (const std::string &isa : yolox_cpp::simd::available_isas())
+                {
+                    ASSERT_TRUE(yolox_cpp::simd::set_isa(isa));
+                    probe.batched_nms(proposals, actual, 0.45f, buckets);
+                    EXPECT_EQ(expected, actual) << method_name(method) << " (" << isa << ") n=" << n;
+                }
+            }
+        }
+    }
+
+    TEST_F(NmsTest, FrameExtentMatchesReference)
+    {
+        // merged tile detections: boxes in frame pixels, far outside a 416 x 416 input
+        const cv::Size frame(1920, 1080);
+        NmsProbe probe(416, 416, 80);
+        for (const size_t n : counts)
+        {
+            const std::vector<Object> proposals = random_proposals(n, frame.width, frame.height, 80, n + 11);
+            NmsScratch scratch;
+            std::vector<int> expected;
+            probe.set_nms_method(NmsMethod::REFERENCE);
+            probe.run_nms(proposals, expected, 0.45f, scratch, frame);
+
+            probe.set_nms_method(NmsMethod::GRID);
+            std::vector<int> actual;
+            probe.run_nms(proposals, actual, 0.45f, scratch, frame);
+            EXPECT_EQ(expected, actual) << "class-agnostic n=" << n;
+
+            ClassBuckets buckets;
+            probe.set_nms_method(NmsMethod::REFERENCE);
+            probe.batched_nms(proposals, expected, 0.45f, buckets, frame);
+            probe.set_nms_method(NmsMethod::GRID);
+            probe.batched_nms(proposals, actual, 0.45f, buckets, frame);
+            EXPECT_EQ(expected, actual) << "class-aware n=" << n;
+        }
+    }
+}
@@ -0,0 +1,240 @@
+// Every kernel set of available_isas() against the scalar kernels.
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "yolox_cpp/simd.hpp"
+
+namespace
+{
+    namespace simd = yolox_cpp::simd;
+
+    // lengths around the 4 / 8 / 16 pixel blocks and their tails
+    const std::vector<size_t> lengths = {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 47, 48, 49, 100, 1021};
+
+    // FMA kernels round once where scalar rounds twice
+    void expect_close(const std::vector<float> &expected, const std::vector<float> &actual, const std::string &isa)
+    {
+        ASSERT_EQ(expected.size(), actual.size());
+        for (size_t i = 0; i < expected.size(); ++i)
+        {
+            EXPECT_NEAR(expected[i], actual[i], 1e-5f * std::max(1.0f, std::fabs(expected[i])))
+                << isa << " index " << i;
+        }
+    }
+
+    class SimdTest : public ::testing::Test
+    {
+    protected:
+        void TearDown() override
+        {
+            simd::set_isa(simd::available_isas().front());
+        }
+
+        std::vector<uint8_t> random_bytes(const size_t n)
+        {
+            std::uniform_int_distribution<int> dist(0, 255);
+            std::vector<uint8_t> v(n);
+            for (auto &b : v)
+            {
+                b = static_cast<uint8_t>(dist(rng_));
+            }
+            return v;
+        }
+
+        std::vector<float> random_floats(const size_t n, const float lo, const float hi)
+        {
+            std::uniform_real_distribution<float> dist(lo, hi);
+            std::vector<float> v(n);
+            for (auto &f : v)
+            {
+                f = dist(rng_);
+            }
+            return v;
+        }
+
+        std::mt19937 rng_{42};
+    };
+
+    TEST_F(SimdTest, ScalarIsAlwaysAvailable)
+    {
+        const std::vector<std::string> isas = simd::available_isas();
+        ASSERT_FALSE(isas.empty());
+        EXPECT_EQ("scalar", isas.back());
+        EXPECT_EQ(isas.front(), simd::active_isa());
+        EXPECT_FALSE(simd::set_isa("no_such_isa"));
+        EXPECT_EQ(isas.front(), simd::active_isa());
+    }
+
+    TEST_F(SimdTest, BgrToPlanarMatchesScalar)
+    {
+        const float scale[3] = {1.0f / (255.0f * 0.229f), 1.0f / (255.0f * 0.224f), 1.0f / (255.0f * 0.225f)};
+        const float bias[3] = {-0.485f / 0.229f, -0.456f / 0.224f, -0.406f / 0.225f};
+        for (const size_t n : lengths)
+        {
+            const std::vector<uint8_t> src = random_bytes(n * 3);
+            std::vector<float> expected(n * 3);
+            ASSERT_TRUE(simd::set_isa("scalar"));
+            simd::bgr_to_planar_f32(src.data(), expected.data(), expected.data() + n, expected.data() + n * 2, n, scale, bias);
+            for (const std::string &isa : simd::available_isas())
+            {
+                ASSERT_TRUE(simd::set_isa(isa));
+                std::vector<float> actual(n * 3, -1.0f);
+                simd::bgr_to_planar_f32(src.data(), actual.data(), actual.data() + n, actual.data() + n * 2, n, scale, bias);
+                expect_close(expected, actual, isa + " n=" + std::to_string(n));
+            }
+        }
+    }
+
+    TEST_F(SimdTest, BgrToInterleavedMatchesScalar)
+    {
+        const float scale[3] = {0.5f, 1.0f, 2.0f};
+        const float bias[3] = {-1.0f, 0.0f, 3.0f};
+        for (const size_t n : lengths)
+        {
+            const std::vector<uint8_t> src = random_bytes(n * 3);
+            std::vector<float> expected(n * 3);
+            ASSERT_TRUE(simd::set_isa("scalar"));
+            simd::bgr_to_interleaved_f32(src.data(), expected.data(), n, scale, bias);
+            for (const std::string &isa : simd::available_isas())
+            {
+                ASSERT_TRUE(simd::set_isa(isa));
+                std::vector<float> actual(n * 3, -1.0f);
+                simd::bgr_to_interleaved_f32(src.data(), actual.data(), n, scale, bias);
+                expect_close(expected, actual, isa + " n=" + std::to_string(n));
+            }
+        }
+    }
+
+    TEST_F(SimdTest, FilterGreaterMatchesScalar)
+    {
+        const size_t stride = 85;
+        for (const size_t n : lengths)
+        {
+            const std::vector<float> data = random_floats(n * stride + 1, 0.0f, 1.0f);
+            std::vector<int> expected(n);
+            ASSERT_TRUE(simd::set_isa("scalar"));
+            expected.resize(simd::filter_greater(data.data(), n, stride, 0.7f, expected.data()));
+            for (const std::string &isa : simd::available_isas())
+            {
+                ASSERT_TRUE(simd::set_isa(isa));
+                std::vector<int> actual(n);
+                actual.resize(simd::filter_greater(data.data(), n, stride, 0.7f, actual.data()));
+                EXPECT_EQ(expected, actual) << isa << " n=" << n;
+            }
+        }
+    }
+
+    TEST_F(SimdTest, DecodeBoxesMatchesScalar)
+    {
+        const size_t num_attrs = 85;
+        const size_t num_anchors = 2100;
+        const std::vector<float> feat = random_floats(num_anchors * num_attrs, -4.0f, 4.0f);
+        const std::vector<float> grid_x = random_floats(num_anchors, 0.0f, 640.0f);
+        const std::vector<float> grid_y = random_floats(num_anchors, 0.0f, 640.0f);
+        std::vector<float> stride(num_anchors);
+        for (size_t i = 0; i < num_anchors; ++i)
+        {
+            stride[i] = static_cast<float>(8 << (i % 3));
+        }
+        std::uniform_int_distribution<int> pick(0, num_anchors - 1);
+        for (const size_t n : lengths)
+        {
+            std::vector<int> anchors(n);
+            for (auto &a : anchors)
+            {
+                a = pick(rng_);
+            }
+            std::vector<float> expected(n * 4);
+            ASSERT_TRUE(simd::set_isa("scalar"));
+            simd::decode_boxes(feat.data(), num_attrs, anchors.data(), n,
+                               grid_x.data(), grid_y.data(), stride.data(), expected.data());
+            for (const std::string &isa : simd::available_isas())
+            {
+                ASSERT_TRUE(simd::set_isa(isa));
+                std::vector<float> actual(n * 4);
+                simd::decode_boxes(feat.data(), num_attrs, anchors.data(), n,
+                                   grid_x.data(), grid_y.data(), stride.data(), actual.data());
+                expect_close(expected, actual, isa + " n=" + std::to_string(n));
+            }
+        }
+    }
+
+    TEST_F(SimdTest, HalfToFloatMatchesScalar)
+    {
+        // every half bit pattern: normals, subnormals, zeros, inf and nan
+        std::vector<uint16_t> src(1 << 16);
+        for (size_t i = 0; i < src.size(); ++i)
+        {
+            src[i] = static_cast<uint16_t>(i);
+        }
+        ASSERT_TRUE(simd::set_isa("scalar"));
+        std::vector<float> expected(src.size());
+        simd::half_to_f32(src.data(), expected.data(), src.size());
+        EXPECT_EQ(1.0f, expected[0x3c00]);
+        EXPECT_EQ(-2.0f, expected[0xc000]);
+        EXPECT_EQ(5.9604644775390625e-8f, expected[0x0001]);
+        EXPECT_TRUE(std::isinf(expected[0x7c00]));
+        for (const std::string &isa : simd::available_isas())
+        {
+            ASSERT_TRUE(simd::set_isa(isa));
+            // starts at 1 so the vector kernels also run their tail
+            std::vector<float> actual(src.size());
+            actual[0] = simd::half_to_f32(src[0]);
+            simd::half_to_f32(src.data() + 1, actual.data() + 1, src.size() - 1);
+            for (size_t i = 0; i < src.size(); ++i)
+            {
+                if (std::isnan(expected[i]))
+                {
+                    // hardware conversion may set the quiet bit of signaling nans
+                    EXPECT_TRUE(std::isnan(actual[i])) << isa << " bits " << i;
+                    continue;
+                }
+                uint32_t expected_bits, actual_bits;
+                std::memcpy(&expected_bits, &expected[i], sizeof(float));
+                std::memcpy(&actual_bits, &actual[i], sizeof(float));
+                EXPECT_EQ(expected_bits, actual_bits) << isa << " bits " << i;
+            }
+        }
+    }
+
+    TEST_F(SimdTest, AnyIouGreaterMatchesScalar)
+    {
+        for (const size_t n : lengths)
+        {
+            std::vector<float> x0 = random_floats(n, 0.0f, 600.0f);
+            std::vector<float> y0 = random_floats(n, 0.0f, 600.0f);
+            const std::vector<float> w = random_floats(n, 1.0f, 80.0f);
+            const std::vector<float> h = random_floats(n, 1.0f, 80.0f);
+            std::vector<float> x1(n), y1(n), area(n);
+            for (size_t j = 0; j < n; ++j)
+            {
+                x1[j] = x0[j] + w[j];
+                y1[j] = y0[j] + h[j];
+                area[j] = w[j] * h[j];
+            }
+            for (int k = 0; k < 64; ++k)
+            {
+                const std::vector<float> b = random_floats(4, 0.0f, 600.0f);
+                const float box[4] = {b[0], b[1], b[0] + 10.0f + b[2] / 10.0f, b[1] + 10.0f + b[3] / 10.0f};
+                const float box_area = (box[2] - box[0]) * (box[3] - box[1]);
+                ASSERT_TRUE(simd::set_isa("scalar"));
+                const bool expected = simd::any_iou_greater(x0.data(), y0.data(), x1.data(), y1.data(), area.data(),
+                                                            n, box, box_area, 0.1f);
+                for (const std::string &isa : simd::available_isas())
+                {
+                    ASSERT_TRUE(simd::set_isa(isa));
+                    EXPECT_EQ(expected, simd::any_iou_greater(x0.data(), y0.data(), x1.data(), y1.data(), area.data(),
+                                                              n, box, box_area, 0.1f))
+                        << isa << " n=" << n;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+namespace yolox_ros_cpp{
+    // Bounded lock-free MPMC ring (sequence-numbered cells, after D. Vyukov).
+    // push / pop never take a lock; the mutex is only used to park an idle consumer.
+    template <typename T>
+    class BoundedQueue
+    {
+    public:
+        // capacity must be at least 2
+        explicit BoundedQueue(size_t capacity)
+            : capacity_(capacity < 2 ? 2 : capacity), cells_(new Cell[capacity_])
+        {
+            for (size_t i = 0; i < this->capacity_; ++i)
+            {
+                this->cells_[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Moves item in and returns true, or leaves it untouched if the queue is full.
+        bool try_push(T &item)
+        {
+            size_t pos = this->enqueue_pos_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell &cell = this->cells_[pos % this->capacity_];
+                const size_t seq = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+                if (diff == 0)
+                {
+                    if (this->enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = std::move(item);
+                        cell.sequence.store(pos + 1, std::memory_order_release);
+                        this->notify();
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = this->enqueue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        bool try_pop(T &item)
+        {
+            size_t pos = this->dequeue_pos_.load(std::memory_order_relaxed);
+            for (;;)
+            {
+                Cell &cell = this->cells_[pos % this->capacity_];
+                const size_t seq = cell.sequence.load(std::memory_order_acquire);
+                const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+                if (diff == 0)
+                {
+                    if (this->dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        item = std::move(cell.value);
+                        cell.value = T();
+                        cell.sequence.store(pos + this->capacity_, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = this->dequeue_pos_.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        // Latest-wins push: drops the oldest entries until item fits.
+        // Returns the number of dropped entries.
+        size_t push_latest(T &item)
+        {
+            size_t dropped = 0;
+            while (!this->try_push(item))
+            {
+                T oldest;
+                if (this->try_pop(oldest))
+                {
+                    ++dropped;
+                }
+            }
+            return dropped;
+        }
+
+        // Pops an entry, parking the caller for at most timeout while the queue is empty.
+        template <typename Rep, typename Period>
+        bool pop_wait(T &item, const std::chrono::duration<Rep, Period> &timeout)
+        {
+            if (this->try_pop(item))
+            {
+                return true;
+            }
+            std::unique_lock<std::mutex> lock(this->park_mutex_);
+            this->waiters_.fetch_add(1);
+            // pairs with the fence in notify(): either the producer sees this waiter,
+            // or the try_pop in the predicate sees its item
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const bool popped = this->park_cv_.wait_for(lock, timeout, [&]() { return this->try_pop(item); });
+            this->waiters_.fetch_sub(1);
+            return popped;
+        }
+
+        // Wakes every parked consumer, e.g. on shutdown.
+        void wake_all()
+        {
+            std::lock_guard<std::mutex> lock(this->park_mutex_);
+            this->park_cv_.notify_all();
+        }
+
+        size_t capacity() const
+        {
+            return this->capacity_;
+        }
+
+    private:
+        struct Cell
+        {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        void notify()
+        {
+            // keeps the release store of the cell sequence from passing the waiters_ load
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->waiters_.load() > 0)
+            {
+                std::lock_guard<std::mutex> lock(this->park_mutex_);
+                this->park_cv_.notify_one();
+            }
+        }
+
+        const size_t capacity_;
+        std::unique_ptr<Cell[]> cells_;
+        alignas(64) std::atomic<size_t> enqueue_pos_{0};
+        alignas(64) std::atomic<size_t> dequeue_pos_{0};
+
+        std::atomic<int> waiters_{0};
+        std::mutex park_mutex_;
+        std::condition_variable park_cv_;
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <rclcpp/rclcpp.hpp>
+#include <rclcpp_components/register_node_macro.hpp>
+#include <sensor_msgs/image_encodings.hpp>
+#include <sensor_msgs/msg/image.hpp>
+#include <vision_msgs/msg/detection2_d_array.hpp>
+
+namespace yolox_ros_cpp{
+    // Camera stand-in for measuring the intra-process path into YoloXNode.
+    // Publishes synthetic bgr8 frames as unique_ptr and reports, per period,
+    //  - copies: frames whose pixel buffer reached a subscriber of the image topic
+    //    at a different address than the one published,
+    //  - latency: image stamp -> detections received.
+    class IntraProcessBench : public rclcpp::Node
+    {
+    public:
+        IntraProcessBench(const rclcpp::NodeOptions &);
+    private:
+        void publishFrame();
+        void imageCallback(const sensor_msgs::msg::Image::ConstSharedPtr &);
+        void detectionCallback(const vision_msgs::msg::Detection2DArray::ConstSharedPtr &);
+        void report();
+
+        int width_;
+        int height_;
+        std::vector<uint8_t> pattern_;
+
+        std::mutex mutex_;
+        // stamp (ns) and pixel buffer address of recently published frames
+        std::deque<std::pair<int64_t, const uint8_t *>> in_flight_;
+        size_t published_ = 0;
+        size_t received_ = 0;
+        size_t copies_ = 0;
+        std::vector<double> latencies_ms_;
+
+        rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub_image_;
+        rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr sub_image_;
+        rclcpp::Subscription<vision_msgs::msg::Detection2DArray>::SharedPtr sub_detection2d_;
+        rclcpp::TimerBase::SharedPtr publish_timer_;
+        rclcpp::TimerBase::SharedPtr report_timer_;
+    };
+}
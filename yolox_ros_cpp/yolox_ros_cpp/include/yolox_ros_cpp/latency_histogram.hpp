@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace yolox_ros_cpp{
+    // Fixed-size log-linear latency histogram (microseconds).
+    // Each power of two is split into sub_buckets_ linear buckets (~6% resolution)
+    // up to ~2 min. record() is lock-free and may be called from any thread.
+    class LatencyHistogram
+    {
+    public:
+        // Percentiles and count of the samples taken since the last take()
+        struct Summary
+        {
+            uint64_t count = 0;
+            double mean = 0.0;
+            double p50 = 0.0;
+            double p95 = 0.0;
+            double p99 = 0.0;
+            double max = 0.0;
+        };
+
+        void record(const double us)
+        {
+            const uint64_t v = us <= 0.0 ? 0 : static_cast<uint64_t>(us);
+            this->buckets_[bucket_index(v)].fetch_add(1, std::memory_order_relaxed);
+            this->sum_.fetch_add(v, std::memory_order_relaxed);
+            uint64_t max = this->max_.load(std::memory_order_relaxed);
+            while (v > max && !this->max_.compare_exchange_weak(max, v, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        // Summarizes and resets. Samples recorded concurrently land in this or the next period.
+        Summary take()
+        {
+            std::array<uint64_t, num_buckets_> counts;
+            Summary summary;
+            for (size_t i = 0; i < num_buckets_; ++i)
+            {
+                counts[i] = this->buckets_[i].exchange(0, std::memory_order_relaxed);
+                summary.count += counts[i];
+            }
+            const uint64_t sum = this->sum_.exchange(0, std::memory_order_relaxed);
+            summary.max = static_cast<double>(this->max_.exchange(0, std::memory_order_relaxed));
+            if (summary.count == 0)
+            {
+                return summary;
+            }
+            summary.mean = static_cast<double>(sum) / summary.count;
+            summary.p50 = percentile(counts, summary.count, 0.50);
+            summary.p95 = percentile(counts, summary.count, 0.95);
+            summary.p99 = percentile(counts, summary.count, 0.99);
+            return summary;
+        }
+
+    private:
+        static constexpr int sub_bits_ = 4;
+        static constexpr uint64_t sub_buckets_ = 1 << sub_bits_;
+        static constexpr int num_octaves_ = 23;
+        static constexpr size_t num_buckets_ = (num_octaves_ + 1) * sub_buckets_;
+
+        // values below sub_buckets_ map 1:1, then sub_buckets_ linear buckets per power of two
+        static size_t bucket_index(const uint64_t v)
+        {
+            if (v < sub_buckets_)
+            {
+                return v;
+            }
+            const int msb = 63 - __builtin_clzll(v);
+            const int octave = msb - sub_bits_ + 1;
+            if (octave > num_octaves_)
+            {
+                return num_buckets_ - 1;
+            }
+            const uint64_t sub = (v >> (msb - sub_bits_)) & (sub_buckets_ - 1);
+            return octave * sub_buckets_ + sub;
+        }
+
+        // midpoint of a bucket
+        static double bucket_value(const size_t index)
+        {
+            if (index < sub_buckets_)
+            {
+                return static_cast<double>(index);
+            }
+            const int octave = index / sub_buckets_;
+            const uint64_t sub = index % sub_buckets_;
+            const int shift = octave - 1;
+            const double lower = static_cast<double>((sub_buckets_ + sub) << shift);
+            return lower + std::ldexp(0.5, shift);
+        }
+
+        static double percentile(const std::array<uint64_t, num_buckets_> &counts, const uint64_t total, const double q)
+        {
+            const uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+            uint64_t seen = 0;
+            for (size_t i = 0; i < num_buckets_; ++i)
+            {
+                seen += counts[i];
+                if (seen >= rank && counts[i] > 0)
+                {
+                    return bucket_value(i);
+                }
+            }
+            return bucket_value(num_buckets_ - 1);
+        }
+
+        std::array<std::atomic<uint64_t>, num_buckets_> buckets_{};
+        std::atomic<uint64_t> sum_{0};
+        std::atomic<uint64_t> max_{0};
+    };
+}
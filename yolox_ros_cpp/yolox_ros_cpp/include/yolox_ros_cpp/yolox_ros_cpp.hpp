@@ -1,16 +1,24 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cmath>
 #include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
 
 #if __has_include(<cv_bridge/cv_bridge.hpp>)
 #include <cv_bridge/cv_bridge.hpp>
 #else
 #include <cv_bridge/cv_bridge.h>
 #endif
+#include <diagnostic_msgs/msg/diagnostic_array.hpp>
 #include <image_transport/image_transport.hpp>
 #include <rclcpp/rclcpp.hpp>
 #include <rclcpp_components/register_node_macro.hpp>
+#include <sensor_msgs/image_encodings.hpp>
 #include <sensor_msgs/msg/image.hpp>
 #include <std_msgs/msg/header.hpp>
 #include <vision_msgs/msg/detection2_d_array.hpp>
@@ -22,30 +30,122 @@
 #include "yolox_cpp/utils.hpp"
 #include "yolox_param/yolox_param.hpp"
 
+#include "yolox_ros_cpp/bounded_queue.hpp"
+#include "yolox_ros_cpp/latency_histogram.hpp"
+
 namespace yolox_ros_cpp{
     class YoloXNode : public rclcpp::Node
     {
     public:
         YoloXNode(const rclcpp::NodeOptions &);
+        ~YoloXNode();
     private:
+        // A frame travelling through the pipeline stages
+        struct Frame
+        {
+            // keeps the pixel data of image alive when it is shared
+            sensor_msgs::msg::Image::ConstSharedPtr msg;
+            std_msgs::msg::Header header;
+            // may point into msg, read-only
+            cv::Mat image;
+            yolox_cpp::PixelFormat format = yolox_cpp::PixelFormat::BGR;
+            // outgoing detections, filled right after inference (one of them, see use_bbox_ex_msgs)
+            vision_msgs::msg::Detection2DArray::UniquePtr detection2d;
+            bboxes_ex_msgs::msg::BoundingBoxes::UniquePtr bboxes;
+            // annotation only: the frame goes to the renderer, with a copy of the detections
+            bool draw = false;
+            std::vector<yolox_cpp::Object> objects;
+            // metrics only
+            std::chrono::steady_clock::time_point received;
+            std::chrono::steady_clock::time_point inferred;
+        };
+        using FramePtr = std::unique_ptr<Frame>;
+        // image message and its arrival time
+        using ReceivedImage = std::pair<sensor_msgs::msg::Image::ConstSharedPtr, std::chrono::steady_clock::time_point>;
+
+        enum MetricStage
+        {
+            RECEIVE,    // callback -> inference start (conversion and queueing)
+            PREPROCESS, // letterbox
+            INFER,      // backend run
+            DECODE,     // proposals and box scaling
+            NMS,
+            PUBLISH,    // inference end -> detections published
+            TOTAL,      // callback -> detections published
+            NUM_METRIC_STAGES
+        };
+
         void onInit();
         void colorImageCallback(const sensor_msgs::msg::Image::ConstSharedPtr &);
 
-        static bboxes_ex_msgs::msg::BoundingBoxes objects_to_bboxes(const cv::Mat &, const std::vector<yolox_cpp::Object> &, const std_msgs::msg::Header &);
-        static vision_msgs::msg::Detection2DArray objects_to_detection2d(const std::vector<yolox_cpp::Object> &, const std_msgs::msg::Header &);
+        // nullptr when the message buffer is smaller than its header says
+        FramePtr convertImage(const ReceivedImage &);
+        void inferFrames(std::vector<FramePtr> &);
+        void setDetections(Frame &, const std::vector<yolox_cpp::Object> &);
+        void publishFrame(FramePtr &);
+        bool hasAnnotationConsumer();
+        size_t imageSubscriberCount();
+        void publishAnnotatedImage(const Frame &);
+
+        // pipeline mode: convert / infer / draw+publish on their own threads
+        void startPipeline();
+        void stopPipeline();
+        void convertLoop();
+        void inferLoop();
+        void publishLoop();
+        template <typename T>
+        void enqueue(BoundedQueue<T> &, T &);
+
+        // annotation: drawing, imshow and the annotated image run on their own thread
+        void startRenderer();
+        void stopRenderer();
+        void renderLoop();
+
+        // latency metrics, published on metrics_topic_name
+        void publishMetrics();
+
+        static void objects_to_bboxes(const cv::Mat &, const std::vector<yolox_cpp::Object> &, const std_msgs::msg::Header &,
+                                      bboxes_ex_msgs::msg::BoundingBoxes &);
+        static void objects_to_detection2d(const std::vector<yolox_cpp::Object> &, const std_msgs::msg::Header &,
+                                           vision_msgs::msg::Detection2DArray &);
 
     protected:
         std::shared_ptr<yolox_parameters::ParamListener> param_listener_;
         yolox_parameters::Params params_;
     private:
         std::unique_ptr<yolox_cpp::AbcYoloX> yolox_;
+        // detections of the last frame, reused by the inference thread
+        std::vector<yolox_cpp::Object> objects_;
         std::vector<std::string> class_names_;
 
         rclcpp::TimerBase::SharedPtr init_timer_;
         image_transport::Subscriber sub_image_;
+        // intra-process comms: plain rclcpp endpoints, messages are handed over as pointers
+        bool use_intra_process_ = false;
+        rclcpp::Subscription<sensor_msgs::msg::Image>::SharedPtr sub_image_ipc_;
+        rclcpp::Publisher<sensor_msgs::msg::Image>::SharedPtr pub_image_ipc_;
 
         rclcpp::Publisher<bboxes_ex_msgs::msg::BoundingBoxes>::SharedPtr pub_bboxes_;
         rclcpp::Publisher<vision_msgs::msg::Detection2DArray>::SharedPtr pub_detection2d_;
         image_transport::Publisher pub_image_;
+
+        bool drop_oldest_ = true;
+        std::atomic<bool> pipeline_running_{false};
+        std::atomic<size_t> pipeline_dropped_{0};
+        std::unique_ptr<BoundedQueue<ReceivedImage>> image_queue_;
+        std::unique_ptr<BoundedQueue<FramePtr>> infer_queue_;
+        std::unique_ptr<BoundedQueue<FramePtr>> publish_queue_;
+        std::vector<std::thread> pipeline_threads_;
+
+        std::atomic<bool> renderer_running_{false};
+        std::unique_ptr<BoundedQueue<FramePtr>> render_queue_;
+        std::thread render_thread_;
+        cv::Mat render_buffer_;
+
+        bool metrics_enabled_ = false;
+        std::array<LatencyHistogram, NUM_METRIC_STAGES> metrics_;
+        std::chrono::steady_clock::time_point metrics_since_;
+        rclcpp::Publisher<diagnostic_msgs::msg::DiagnosticArray>::SharedPtr pub_metrics_;
+        rclcpp::TimerBase::SharedPtr metrics_timer_;
     };
 }
@@ -0,0 +1,99 @@
+import launch
+from launch.actions import DeclareLaunchArgument
+from launch.substitutions import LaunchConfiguration
+from launch_ros.actions import ComposableNodeContainer
+from launch_ros.descriptions import ComposableNode
+
+def generate_launch_description():
+    launch_args = [
+        DeclareLaunchArgument(
+            'model_type',
+            default_value='onnxruntime',
+            description='model type. tensorrt, openvino, onnxruntime, tflite or null (no model).'
+        ),
+        DeclareLaunchArgument(
+            'null_latency_ms',
+            default_value='0.0',
+            description='model_type null: time spent in place of inference, per frame.'
+        ),
+        DeclareLaunchArgument(
+            'model_path',
+            default_value='./src/YOLOX-ROS/weights/onnx/yolox_tiny.onnx',
+            description='yolox model path.'
+        ),
+        DeclareLaunchArgument(
+            'num_classes',
+            default_value='80',
+            description='num classes.'
+        ),
+        DeclareLaunchArgument(
+            'use_intra_process_comms',
+            default_value='true',
+            description='hand frames over by pointer. set false to compare with the copying path.'
+        ),
+        DeclareLaunchArgument(
+            'width',
+            default_value='1280',
+            description='synthetic frame width.'
+        ),
+        DeclareLaunchArgument(
+            'height',
+            default_value='720',
+            description='synthetic frame height.'
+        ),
+        DeclareLaunchArgument(
+            'rate',
+            default_value='30.0',
+            description='synthetic frame rate [Hz], must be positive.'
+        ),
+        DeclareLaunchArgument(
+            'publish_resized_image',
+            default_value='false',
+            description='also publish the annotated image.'
+        ),
+    ]
+    container = ComposableNodeContainer(
+        name='yolox_bench_container',
+        namespace='',
+        package='rclcpp_components',
+        executable='component_container_mt',
+        composable_node_descriptions=[
+            ComposableNode(
+                package='yolox_ros_cpp',
+                plugin='yolox_ros_cpp::IntraProcessBench',
+                name='intra_process_bench',
+                parameters=[{
+                    'image_topic_name': '/image_raw',
+                    'detection_topic_name': '/yolox/bounding_boxes',
+                    'width': LaunchConfiguration('width'),
+                    'height': LaunchConfiguration('height'),
+                    'rate': LaunchConfiguration('rate'),
+                }],
+                extra_arguments=[{'use_intra_process_comms': LaunchConfiguration('use_intra_process_comms')}],
+                ),
+            ComposableNode(
+                package='yolox_ros_cpp',
+                plugin='yolox_ros_cpp::YoloXNode',
+                name='yolox_ros_cpp',
+                parameters=[{
+                    'model_path': LaunchConfiguration('model_path'),
+                    'model_type': LaunchConfiguration('model_type'),
+                    'num_classes': LaunchConfiguration('num_classes'),
+                    'null_latency_ms': LaunchConfiguration('null_latency_ms'),
+                    'imshow_isshow': False,
+                    'src_image_topic_name': '/image_raw',
+                    'publish_boundingbox_topic_name': '/yolox/bounding_boxes',
+                    'publish_resized_image': LaunchConfiguration('publish_resized_image'),
+                }],
+                extra_arguments=[{'use_intra_process_comms': LaunchConfiguration('use_intra_process_comms')}],
+                ),
+        ],
+        output='screen',
+    )
+
+    return launch.LaunchDescription(
+        launch_args +
+        [
+            container
+        ]
+    )
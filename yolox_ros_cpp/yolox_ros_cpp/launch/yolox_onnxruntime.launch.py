@@ -75,6 +75,26 @@ def generate_launch_description():
             default_value='1',
             description='ontrols the number of threads to use to run the model.'
         ),
+        DeclareLaunchArgument(
+            'onnxruntime_warmup_runs',
+            default_value='1',
+            description='inference runs at model load.'
+        ),
+        DeclareLaunchArgument(
+            'onnxruntime_cpu_mem_arena',
+            default_value='true',
+            description='enable the CPU memory arena.'
+        ),
+        DeclareLaunchArgument(
+            'onnxruntime_share_allocator',
+            default_value='false',
+            description='one CPU arena for all onnxruntime sessions of the process.'
+        ),
+        DeclareLaunchArgument(
+            'onnxruntime_optimized_model_path',
+            default_value='',
+            description='optimized graph saved on the first start and loaded afterwards. empty: disabled.'
+        ),
         DeclareLaunchArgument(
             'conf',
             default_value='0.30',
@@ -146,6 +166,10 @@ def generate_launch_description():
                     'onnxruntime_use_parallel': LaunchConfiguration('onnxruntime_use_parallel'),
                     'onnxruntime_inter_op_num_threads': LaunchConfiguration('onnxruntime_inter_op_num_threads'),
                     'onnxruntime_intra_op_num_threads': LaunchConfiguration('onnxruntime_intra_op_num_threads'),
+                    'onnxruntime_warmup_runs': LaunchConfiguration('onnxruntime_warmup_runs'),
+                    'onnxruntime_cpu_mem_arena': LaunchConfiguration('onnxruntime_cpu_mem_arena'),
+                    'onnxruntime_share_allocator': LaunchConfiguration('onnxruntime_share_allocator'),
+                    'onnxruntime_optimized_model_path': LaunchConfiguration('onnxruntime_optimized_model_path'),
                     'conf': LaunchConfiguration('conf'),
                     'nms': LaunchConfiguration('nms'),
                     'imshow_isshow': LaunchConfiguration('imshow_isshow'),
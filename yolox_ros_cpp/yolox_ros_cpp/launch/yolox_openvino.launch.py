@@ -41,6 +41,23 @@ def generate_launch_description():
             default_value='CPU',
             description='model device. CPU, GPU, MYRIAD, etc...'
         ),
+        DeclareLaunchArgument(
+            'openvino_num_infer_requests',
+            default_value='1',
+            description='infer request pool size. 1: sync, 0: plugin optimal, >1: async. '
+                        'Only batched / pipelined input uses the pool (pipeline_mode with pipeline_max_batch > 1); '
+                        'single frames always run synchronously.'
+        ),
+        DeclareLaunchArgument(
+            'openvino_cache_dir',
+            default_value='',
+            description='compiled model cache directory. empty: no cache.'
+        ),
+        DeclareLaunchArgument(
+            'openvino_embed_preprocess',
+            default_value='false',
+            description='convert and normalize the uint8 input inside the compiled model.'
+        ),
         DeclareLaunchArgument(
             'conf',
             default_value='0.30',
@@ -108,6 +125,9 @@ def generate_launch_description():
                     'model_type': 'openvino',
                     'model_version': LaunchConfiguration('model_version'),
                     'openvino_device': LaunchConfiguration('openvino_device'),
+                    'openvino_num_infer_requests': LaunchConfiguration('openvino_num_infer_requests'),
+                    'openvino_cache_dir': LaunchConfiguration('openvino_cache_dir'),
+                    'openvino_embed_preprocess': LaunchConfiguration('openvino_embed_preprocess'),
                     'conf': LaunchConfiguration('conf'),
                     'nms': LaunchConfiguration('nms'),
                     'imshow_isshow': LaunchConfiguration('imshow_isshow'),
@@ -0,0 +1,131 @@
+#include "yolox_ros_cpp/intra_process_bench.hpp"
+
+#include <algorithm>
+
+namespace yolox_ros_cpp
+{
+    namespace
+    {
+        rcl_interfaces::msg::ParameterDescriptor positive_range(const std::string &description)
+        {
+            rcl_interfaces::msg::ParameterDescriptor descriptor;
+            descriptor.description = description;
+            rcl_interfaces::msg::FloatingPointRange range;
+            range.from_value = 1e-3;
+            range.to_value = 1e6;
+            descriptor.floating_point_range.push_back(range);
+            return descriptor;
+        }
+    }
+
+    IntraProcessBench::IntraProcessBench(const rclcpp::NodeOptions &options)
+        : Node("intra_process_bench", options)
+    {
+        const auto image_topic = this->declare_parameter<std::string>("image_topic_name", "image_raw");
+        const auto detection_topic = this->declare_parameter<std::string>("detection_topic_name", "yolox/bounding_boxes");
+        this->width_ = this->declare_parameter<int>("width", 1280);
+        this->height_ = this->declare_parameter<int>("height", 720);
+        // both set a timer period, so declaring a non-positive value throws
+        const double rate = this->declare_parameter<double>("rate", 30.0, positive_range("publish rate [Hz]"));
+        const double report_period = this->declare_parameter<double>(
+            "report_period", 5.0, positive_range("report period [s]"));
+
+        this->pattern_.resize(static_cast<size_t>(this->width_) * this->height_ * 3);
+        for (size_t i = 0; i < this->pattern_.size(); ++i)
+        {
+            this->pattern_[i] = static_cast<uint8_t>((i * 7) ^ (i >> 9));
+        }
+
+        if (!this->get_node_options().use_intra_process_comms())
+        {
+            RCLCPP_WARN(this->get_logger(), "intra-process comms is disabled, every frame will be copied");
+        }
+
+        this->pub_image_ = this->create_publisher<sensor_msgs::msg::Image>(image_topic, 10);
+        this->sub_image_ = this->create_subscription<sensor_msgs::msg::Image>(
+            image_topic, 10,
+            std::bind(&IntraProcessBench::imageCallback, this, std::placeholders::_1));
+        this->sub_detection2d_ = this->create_subscription<vision_msgs::msg::Detection2DArray>(
+            detection_topic, 10,
+            std::bind(&IntraProcessBench::detectionCallback, this, std::placeholders::_1));
+
+        this->publish_timer_ = this->create_wall_timer(
+            std::chrono::duration<double>(1.0 / rate),
+            std::bind(&IntraProcessBench::publishFrame, this));
+        this->report_timer_ = this->create_wall_timer(
+            std::chrono::duration<double>(report_period),
+            std::bind(&IntraProcessBench::report, this));
+    }
+
+    void IntraProcessBench::publishFrame()
+    {
+        auto msg = std::make_unique<sensor_msgs::msg::Image>();
+        msg->header.stamp = this->now();
+        msg->header.frame_id = "camera";
+        msg->height = this->height_;
+        msg->width = this->width_;
+        msg->encoding = sensor_msgs::image_encodings::BGR8;
+        msg->is_bigendian = false;
+        msg->step = this->width_ * 3;
+        msg->data = this->pattern_;
+
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            this->in_flight_.emplace_back(rclcpp::Time(msg->header.stamp).nanoseconds(), msg->data.data());
+            if (this->in_flight_.size() > 64)
+            {
+                this->in_flight_.pop_front();
+            }
+            ++this->published_;
+        }
+        this->pub_image_->publish(std::move(msg));
+    }
+
+    void IntraProcessBench::imageCallback(const sensor_msgs::msg::Image::ConstSharedPtr &msg)
+    {
+        // Subscribers taking a const shared pointer all get the same message,
+        // so the address seen here is the one YoloXNode sees.
+        const int64_t stamp = rclcpp::Time(msg->header.stamp).nanoseconds();
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        ++this->received_;
+        const auto it = std::find_if(this->in_flight_.begin(), this->in_flight_.end(),
+                                     [stamp](const std::pair<int64_t, const uint8_t *> &entry)
+                                     {
+                                         return entry.first == stamp;
+                                     });
+        if (it == this->in_flight_.end() || it->second != msg->data.data())
+        {
+            ++this->copies_;
+        }
+    }
+
+    void IntraProcessBench::detectionCallback(const vision_msgs::msg::Detection2DArray::ConstSharedPtr &msg)
+    {
+        const double latency = (this->now() - rclcpp::Time(msg->header.stamp)).seconds() * 1000.0;
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->latencies_ms_.push_back(latency);
+    }
+
+    void IntraProcessBench::report()
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        auto &lat = this->latencies_ms_;
+        double p50 = 0.0, p99 = 0.0, max = 0.0;
+        if (!lat.empty())
+        {
+            std::sort(lat.begin(), lat.end());
+            p50 = lat[lat.size() / 2];
+            p99 = lat[std::min(lat.size() - 1, lat.size() * 99 / 100)];
+            max = lat.back();
+        }
+        RCLCPP_INFO(this->get_logger(),
+                    "published: %zu, received: %zu, copies: %zu, detections: %zu, latency p50: %.2f ms, p99: %.2f ms, max: %.2f ms",
+                    this->published_, this->received_, this->copies_, lat.size(), p50, p99, max);
+        this->published_ = 0;
+        this->received_ = 0;
+        this->copies_ = 0;
+        lat.clear();
+    }
+}
+
+RCLCPP_COMPONENTS_REGISTER_NODE(yolox_ros_cpp::IntraProcessBench)
@@ -10,6 +10,12 @@ namespace yolox_ros_cpp
             0s, std::bind(&YoloXNode::onInit, this));
     }
 
+    YoloXNode::~YoloXNode()
+    {
+        this->stopPipeline();
+        this->stopRenderer();
+    }
+
     void YoloXNode::onInit()
     {
         this->init_timer_->cancel();
@@ -18,11 +24,6 @@ namespace yolox_ros_cpp
 
         this->params_ = this->param_listener_->get_params();
 
-        if (this->params_.imshow_isshow)
-        {
-            cv::namedWindow("yolox", cv::WINDOW_AUTOSIZE);
-        }
-
         if (this->params_.class_labels_path != "")
         {
             RCLCPP_INFO(this->get_logger(), "read class labels from '%s'", this->params_.class_labels_path.c_str());
@@ -53,7 +54,9 @@ namespace yolox_ros_cpp
             this->yolox_ = std::make_unique<yolox_cpp::YoloXOpenVINO>(
                 this->params_.model_path, this->params_.openvino_device,
                 this->params_.nms, this->params_.conf, this->params_.model_version,
-                this->params_.num_classes, this->params_.p6);
+                this->params_.num_classes, this->params_.p6,
+                this->params_.openvino_num_infer_requests,
+                this->params_.openvino_cache_dir, this->params_.openvino_embed_preprocess);
 #else
             RCLCPP_ERROR(this->get_logger(), "yolox_cpp is not built with OpenVINO");
             rclcpp::shutdown();
@@ -70,7 +73,9 @@ namespace yolox_ros_cpp
                 this->params_.onnxruntime_use_cuda, this->params_.onnxruntime_device_id,
                 this->params_.onnxruntime_use_parallel,
                 this->params_.nms, this->params_.conf, this->params_.model_version,
-                this->params_.num_classes, this->params_.p6);
+                this->params_.num_classes, this->params_.p6,
+                this->params_.onnxruntime_warmup_runs, this->params_.onnxruntime_share_allocator,
+                this->params_.onnxruntime_cpu_mem_arena, this->params_.onnxruntime_optimized_model_path);
 #else
             RCLCPP_ERROR(this->get_logger(), "yolox_cpp is not built with ONNXRuntime");
             rclcpp::shutdown();
@@ -89,12 +94,70 @@ namespace yolox_ros_cpp
             rclcpp::shutdown();
 #endif
         }
+        else if (this->params_.model_type == "null")
+        {
+            RCLCPP_INFO(this->get_logger(), "Model Type is null (%.1f ms per frame)", this->params_.null_latency_ms);
+            this->yolox_ = std::make_unique<yolox_cpp::YoloXNull>(
+                this->params_.null_output_path,
+                this->params_.null_input_width, this->params_.null_input_height,
+                this->params_.null_latency_ms, this->params_.null_proposal_density,
+                this->params_.nms, this->params_.conf, this->params_.model_version,
+                this->params_.num_classes, this->params_.p6);
+        }
+        if (this->yolox_ == nullptr)
+        {
+            RCLCPP_ERROR(this->get_logger(), "model is not loaded (model_type: '%s')", this->params_.model_type.c_str());
+            return;
+        }
+        const auto output_format = yolox_cpp::output_format_from_name(this->params_.output_format);
+        if (output_format == yolox_cpp::OutputFormat::NMS && !this->yolox_->supports_nms_output())
+        {
+            RCLCPP_ERROR(this->get_logger(), "output_format 'nms' is not supported by model_type '%s'",
+                         this->params_.model_type.c_str());
+            return;
+        }
+        this->yolox_->set_output_format(output_format);
+        this->yolox_->set_nms_method(yolox_cpp::nms_method_from_name(this->params_.nms_method));
+        this->yolox_->set_class_agnostic_nms(this->params_.nms_class_agnostic);
+        this->yolox_->set_max_proposals(this->params_.nms_max_proposals);
+        if (this->params_.dynamic_input)
+        {
+            if (this->yolox_->supports_dynamic_input())
+            {
+                this->yolox_->set_dynamic_input(this->params_.dynamic_input_width, this->params_.dynamic_input_height);
+            }
+            else
+            {
+                RCLCPP_WARN(this->get_logger(), "dynamic_input is ignored: the model input size is fixed");
+            }
+        }
+        if (this->params_.tiling)
+        {
+            this->yolox_->set_tiling(this->params_.tile_width, this->params_.tile_height,
+                                     this->params_.tile_overlap, this->params_.tile_global_view);
+        }
         RCLCPP_INFO(this->get_logger(), "model loaded");
+        RCLCPP_INFO(this->get_logger(), "preprocess kernels: %s", yolox_cpp::simd::active_isa());
 
-        this->sub_image_ = image_transport::create_subscription(
-            this, this->params_.src_image_topic_name,
-            std::bind(&YoloXNode::colorImageCallback, this, std::placeholders::_1),
-            "raw");
+        // Inside a component container with intra-process comms, image_transport would copy
+        // every image, so plain rclcpp endpoints are used and frames are shared by pointer.
+        this->use_intra_process_ = this->get_node_options().use_intra_process_comms();
+        if (this->use_intra_process_)
+        {
+            RCLCPP_INFO(this->get_logger(), "intra-process comms enabled");
+            // const shared pointer callback: the published message is shared, not copied,
+            // even when other nodes in the container subscribe to the same topic
+            this->sub_image_ipc_ = this->create_subscription<sensor_msgs::msg::Image>(
+                this->params_.src_image_topic_name, 10,
+                std::bind(&YoloXNode::colorImageCallback, this, std::placeholders::_1));
+        }
+        else
+        {
+            this->sub_image_ = image_transport::create_subscription(
+                this, this->params_.src_image_topic_name,
+                std::bind(&YoloXNode::colorImageCallback, this, std::placeholders::_1),
+                "raw");
+        }
 
         if (this->params_.use_bbox_ex_msgs) {
             this->pub_bboxes_ = this->create_publisher<bboxes_ex_msgs::msg::BoundingBoxes>(
@@ -107,33 +170,223 @@ namespace yolox_ros_cpp
         }
 
         if (this->params_.publish_resized_image) {
-            this->pub_image_ = image_transport::create_publisher(this, this->params_.publish_image_topic_name);
+            if (this->use_intra_process_)
+            {
+                this->pub_image_ipc_ = this->create_publisher<sensor_msgs::msg::Image>(
+                    this->params_.publish_image_topic_name, 10);
+            }
+            else
+            {
+                this->pub_image_ = image_transport::create_publisher(this, this->params_.publish_image_topic_name);
+            }
+        }
+
+        if (this->params_.metrics_enable)
+        {
+            this->metrics_enabled_ = true;
+            this->yolox_->set_profiling(true);
+            this->metrics_since_ = std::chrono::steady_clock::now();
+            this->pub_metrics_ = this->create_publisher<diagnostic_msgs::msg::DiagnosticArray>(
+                this->params_.metrics_topic_name, 10);
+            this->metrics_timer_ = this->create_wall_timer(
+                std::chrono::duration<double>(this->params_.metrics_period),
+                std::bind(&YoloXNode::publishMetrics, this));
+        }
+
+        if (this->params_.imshow_isshow || this->params_.publish_resized_image)
+        {
+            this->startRenderer();
+        }
+        if (this->params_.pipeline_mode)
+        {
+            this->startPipeline();
         }
     }
 
     void YoloXNode::colorImageCallback(const sensor_msgs::msg::Image::ConstSharedPtr &ptr)
     {
-        auto img = cv_bridge::toCvCopy(ptr, "bgr8");
-        cv::Mat frame = img->image;
+        ReceivedImage received(ptr, {});
+        if (this->metrics_enabled_)
+        {
+            received.second = std::chrono::steady_clock::now();
+        }
+        if (this->pipeline_running_)
+        {
+            this->enqueue(*this->image_queue_, received);
+            return;
+        }
 
-        auto now = std::chrono::system_clock::now();
-        auto objects = this->yolox_->inference(frame);
-        auto end = std::chrono::system_clock::now();
+        FramePtr frame = this->convertImage(received);
+        if (!frame)
+        {
+            return;
+        }
+        std::vector<FramePtr> frames;
+        frames.emplace_back(std::move(frame));
+        this->inferFrames(frames);
+        this->publishFrame(frames[0]);
+    }
 
-        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - now);
-        RCLCPP_INFO(this->get_logger(), "Inference time: %5ld us", elapsed.count());
+    YoloXNode::FramePtr YoloXNode::convertImage(const ReceivedImage &received)
+    {
+        const auto &ptr = received.first;
+        auto frame = std::make_unique<Frame>();
+        frame->header = ptr->header;
+        frame->received = received.second;
+        const std::string &encoding = ptr->encoding;
+        if (encoding == sensor_msgs::image_encodings::BGR8)
+        {
+            // no copy, the frame shares the message buffer
+            frame->msg = ptr;
+            frame->image = cv_bridge::toCvShare(ptr)->image;
+            return frame;
+        }
 
-        yolox_cpp::utils::draw_objects(frame, objects, this->class_names_);
-        if (this->params_.imshow_isshow)
+        // layouts the letterbox converts on the fly
+        int type = -1;
+        int rows = ptr->height;
+        if (encoding == sensor_msgs::image_encodings::RGB8)
+        {
+            frame->format = yolox_cpp::PixelFormat::RGB;
+            type = CV_8UC3;
+        }
+        else if (encoding == "yuv422" || encoding == "uyvy")
+        {
+            frame->format = yolox_cpp::PixelFormat::UYVY;
+            type = CV_8UC2;
+        }
+        else if (encoding == "yuv422_yuy2" || encoding == "yuyv")
         {
-            cv::imshow("yolox", frame);
-            auto key = cv::waitKey(1);
-            if (key == 27)
+            frame->format = yolox_cpp::PixelFormat::YUYV;
+            type = CV_8UC2;
+        }
+        else if (encoding == "nv12")
+        {
+            // the Y plane, then the interleaved UV plane at half height
+            frame->format = yolox_cpp::PixelFormat::NV12;
+            type = CV_8UC1;
+            rows = ptr->height * 3 / 2;
+        }
+
+        if (type >= 0)
+        {
+            // the Mat wraps the message buffer, so it must hold every row it claims
+            const size_t row_bytes = static_cast<size_t>(ptr->width) * CV_ELEM_SIZE(type);
+            const bool odd_nv12 = frame->format == yolox_cpp::PixelFormat::NV12 &&
+                                  (ptr->width % 2 != 0 || ptr->height % 2 != 0);
+            if (ptr->step < row_bytes || odd_nv12 ||
+                ptr->data.size() < static_cast<size_t>(ptr->step) * rows)
+            {
+                RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 5000,
+                                     "dropping malformed '%s' image: %ux%u, step %u, %zu bytes",
+                                     encoding.c_str(), ptr->width, ptr->height, ptr->step, ptr->data.size());
+                return nullptr;
+            }
+            frame->msg = ptr;
+            frame->image = cv::Mat(rows, ptr->width, type,
+                                   const_cast<uint8_t *>(ptr->data.data()), ptr->step);
+        }
+        else
+        {
+            frame->format = yolox_cpp::PixelFormat::BGR;
+            frame->image = cv_bridge::toCvCopy(ptr, "bgr8")->image;
+        }
+        return frame;
+    }
+
+    void YoloXNode::inferFrames(std::vector<FramePtr> &frames)
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (this->metrics_enabled_)
+        {
+            for (const auto &frame : frames)
+            {
+                this->metrics_[RECEIVE].record(std::chrono::duration<double, std::micro>(now - frame->received).count());
+            }
+        }
+        auto record_stage_times = [this]()
+        {
+            if (this->metrics_enabled_)
+            {
+                const yolox_cpp::StageTimes &times = this->yolox_->last_stage_times();
+                this->metrics_[PREPROCESS].record(times.preprocess);
+                this->metrics_[INFER].record(times.infer);
+                this->metrics_[DECODE].record(times.decode);
+                this->metrics_[NMS].record(times.nms);
+            }
+        };
+
+        const bool same_format = std::all_of(frames.begin(), frames.end(), [&](const FramePtr &frame)
+        {
+            return frame->format == frames[0]->format;
+        });
+        if (this->params_.tiling)
+        {
+            // the tiles of each frame are the batch
+            for (auto &frame : frames)
+            {
+                this->yolox_->inference_tiled(frame->image, frame->format, this->objects_);
+                record_stage_times();
+                this->setDetections(*frame, this->objects_);
+            }
+        }
+        else if (frames.size() > 1 && same_format)
+        {
+            std::vector<cv::Mat> images;
+            images.reserve(frames.size());
+            for (const auto &frame : frames)
+            {
+                images.emplace_back(frame->image);
+            }
+            auto objects = this->yolox_->inference_batch(images, frames[0]->format);
+            record_stage_times();
+            for (size_t i = 0; i < frames.size(); ++i)
+            {
+                this->setDetections(*frames[i], objects[i]);
+            }
+        }
+        else
+        {
+            for (auto &frame : frames)
             {
-                rclcpp::shutdown();
+                this->yolox_->inference(frame->image, frame->format, this->objects_);
+                record_stage_times();
+                this->setDetections(*frame, this->objects_);
             }
         }
+        auto end = std::chrono::steady_clock::now();
+        for (auto &frame : frames)
+        {
+            frame->inferred = end;
+        }
 
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(end - now);
+        RCLCPP_DEBUG(this->get_logger(), "Inference time: %5ld us (%zu frames)", elapsed.count(), frames.size());
+    }
+
+    void YoloXNode::setDetections(Frame &frame, const std::vector<yolox_cpp::Object> &objects)
+    {
+        // the outgoing message is filled straight from the decoder output
+        if (this->params_.use_bbox_ex_msgs)
+        {
+            frame.bboxes = std::make_unique<bboxes_ex_msgs::msg::BoundingBoxes>();
+            objects_to_bboxes(frame.image, objects, frame.header, *frame.bboxes);
+        }
+        else
+        {
+            frame.detection2d = std::make_unique<vision_msgs::msg::Detection2DArray>();
+            objects_to_detection2d(objects, frame.header, *frame.detection2d);
+        }
+
+        frame.draw = this->renderer_running_ && this->hasAnnotationConsumer();
+        if (frame.draw)
+        {
+            frame.objects = objects;
+        }
+    }
+
+    void YoloXNode::publishFrame(FramePtr &frame)
+    {
         if (this->params_.use_bbox_ex_msgs)
         {
             if (this->pub_bboxes_ == nullptr)
@@ -141,8 +394,7 @@ namespace yolox_ros_cpp
                 RCLCPP_ERROR(this->get_logger(), "pub_bboxes_ is nullptr");
                 return;
             }
-            auto boxes = objects_to_bboxes(frame, objects, img->header);
-            this->pub_bboxes_->publish(boxes);
+            this->pub_bboxes_->publish(std::move(frame->bboxes));
         }
         else
         {
@@ -151,26 +403,309 @@ namespace yolox_ros_cpp
                 RCLCPP_ERROR(this->get_logger(), "pub_detection2d_ is nullptr");
                 return;
             }
-            vision_msgs::msg::Detection2DArray detections = objects_to_detection2d(objects, img->header);
-            this->pub_detection2d_->publish(detections);
+            this->pub_detection2d_->publish(std::move(frame->detection2d));
         }
 
-        if (this->params_.publish_resized_image) {
-            sensor_msgs::msg::Image::SharedPtr pub_img =
-                cv_bridge::CvImage(img->header, "bgr8", frame).toImageMsg();
-            this->pub_image_.publish(pub_img);
+        if (this->metrics_enabled_)
+        {
+            const auto published = std::chrono::steady_clock::now();
+            this->metrics_[PUBLISH].record(std::chrono::duration<double, std::micro>(published - frame->inferred).count());
+            this->metrics_[TOTAL].record(std::chrono::duration<double, std::micro>(published - frame->received).count());
+        }
+
+        // Drawing is handed to the render thread (latest wins), so detections
+        // never wait on it, and skipped when nobody would see the result.
+        if (frame->draw)
+        {
+            this->render_queue_->push_latest(frame);
+        }
+    }
+
+    void YoloXNode::publishMetrics()
+    {
+        static const char *stage_names[NUM_METRIC_STAGES] = {
+            "receive", "preprocess", "infer", "decode", "nms", "publish", "total"};
+
+        const auto now = std::chrono::steady_clock::now();
+        const double period = std::chrono::duration<double>(now - this->metrics_since_).count();
+        this->metrics_since_ = now;
+
+        diagnostic_msgs::msg::DiagnosticStatus status;
+        status.level = diagnostic_msgs::msg::DiagnosticStatus::OK;
+        status.name = std::string(this->get_name()) + ": latency";
+        status.message = "milliseconds per stage";
+        auto add_value = [&status](const std::string &key, const double value)
+        {
+            diagnostic_msgs::msg::KeyValue kv;
+            kv.key = key;
+            kv.value = std::to_string(value);
+            status.values.emplace_back(kv);
+        };
+        for (int stage = 0; stage < NUM_METRIC_STAGES; ++stage)
+        {
+            const LatencyHistogram::Summary summary = this->metrics_[stage].take();
+            const std::string name = stage_names[stage];
+            if (stage == TOTAL)
+            {
+                add_value("fps", period > 0.0 ? summary.count / period : 0.0);
+            }
+            add_value(name + ".mean", summary.mean / 1000.0);
+            add_value(name + ".p50", summary.p50 / 1000.0);
+            add_value(name + ".p95", summary.p95 / 1000.0);
+            add_value(name + ".p99", summary.p99 / 1000.0);
+            add_value(name + ".max", summary.max / 1000.0);
+        }
+        add_value("dropped", static_cast<double>(this->pipeline_dropped_.load()));
+
+        auto msg = std::make_unique<diagnostic_msgs::msg::DiagnosticArray>();
+        msg->header.stamp = this->now();
+        msg->status.emplace_back(std::move(status));
+        this->pub_metrics_->publish(std::move(msg));
+    }
+
+    bool YoloXNode::hasAnnotationConsumer()
+    {
+        if (this->params_.imshow_isshow)
+        {
+            return true;
+        }
+        return this->params_.publish_resized_image && this->imageSubscriberCount() > 0;
+    }
+
+    size_t YoloXNode::imageSubscriberCount()
+    {
+        if (this->use_intra_process_)
+        {
+            return this->pub_image_ipc_->get_subscription_count();
+        }
+        return this->pub_image_.getNumSubscribers();
+    }
+
+    void YoloXNode::publishAnnotatedImage(const Frame &frame)
+    {
+        // draw straight into the outgoing message buffer
+        auto msg = std::make_unique<sensor_msgs::msg::Image>();
+        msg->header = frame.header;
+        const cv::Size size = yolox_cpp::image_size(frame.image, frame.format);
+        msg->height = size.height;
+        msg->width = size.width;
+        msg->encoding = sensor_msgs::image_encodings::BGR8;
+        msg->is_bigendian = false;
+        msg->step = msg->width * 3;
+        msg->data.resize(static_cast<size_t>(msg->step) * msg->height);
+        cv::Mat annotated(msg->height, msg->width, CV_8UC3, msg->data.data(), msg->step);
+        yolox_cpp::utils::to_bgr(frame.image, frame.format, annotated);
+        yolox_cpp::utils::draw_objects(annotated, frame.objects, this->class_names_);
+
+        if (this->params_.imshow_isshow)
+        {
+            cv::imshow("yolox", annotated);
+        }
+        if (this->use_intra_process_)
+        {
+            this->pub_image_ipc_->publish(std::move(msg));
+        }
+        else
+        {
+            this->pub_image_.publish(*msg);
+        }
+    }
+
+    void YoloXNode::startRenderer()
+    {
+        this->render_queue_ = std::make_unique<BoundedQueue<FramePtr>>(2);
+        this->renderer_running_ = true;
+        this->render_thread_ = std::thread(&YoloXNode::renderLoop, this);
+    }
+
+    void YoloXNode::stopRenderer()
+    {
+        if (!this->renderer_running_.exchange(false))
+        {
+            return;
+        }
+        this->render_queue_->wake_all();
+        this->render_thread_.join();
+    }
+
+    void YoloXNode::renderLoop()
+    {
+        using namespace std::chrono_literals; // NOLINT
+        if (this->params_.imshow_isshow)
+        {
+            cv::namedWindow("yolox", cv::WINDOW_AUTOSIZE);
+        }
+
+        FramePtr frame;
+        while (this->renderer_running_)
+        {
+            if (!this->render_queue_->pop_wait(frame, 100ms))
+            {
+                continue;
+            }
+            // frame->image may share the message buffer, so draw on a BGR copy
+            if (this->params_.publish_resized_image && this->imageSubscriberCount() > 0)
+            {
+                this->publishAnnotatedImage(*frame);
+            }
+            else if (this->params_.imshow_isshow)
+            {
+                yolox_cpp::utils::to_bgr(frame->image, frame->format, this->render_buffer_);
+                yolox_cpp::utils::draw_objects(this->render_buffer_, frame->objects, this->class_names_);
+                cv::imshow("yolox", this->render_buffer_);
+            }
+            if (this->params_.imshow_isshow)
+            {
+                auto key = cv::waitKey(1);
+                if (key == 27)
+                {
+                    rclcpp::shutdown();
+                }
+            }
+            frame.reset();
+        }
+    }
+
+    void YoloXNode::startPipeline()
+    {
+        const size_t queue_size = this->params_.pipeline_queue_size;
+        this->drop_oldest_ = this->params_.pipeline_drop_policy == "latest";
+        this->image_queue_ = std::make_unique<BoundedQueue<ReceivedImage>>(queue_size);
+        this->infer_queue_ = std::make_unique<BoundedQueue<FramePtr>>(queue_size);
+        this->publish_queue_ = std::make_unique<BoundedQueue<FramePtr>>(queue_size);
+
+        this->pipeline_running_ = true;
+        this->pipeline_threads_.emplace_back(&YoloXNode::convertLoop, this);
+        this->pipeline_threads_.emplace_back(&YoloXNode::inferLoop, this);
+        this->pipeline_threads_.emplace_back(&YoloXNode::publishLoop, this);
+        RCLCPP_INFO(this->get_logger(), "pipeline mode (queue size: %zu, drop policy: %s, max batch: %lld)",
+                    this->image_queue_->capacity(), this->params_.pipeline_drop_policy.c_str(),
+                    static_cast<long long>(this->params_.pipeline_max_batch));
+    }
+
+    void YoloXNode::stopPipeline()
+    {
+        if (!this->pipeline_running_.exchange(false))
+        {
+            return;
+        }
+        this->image_queue_->wake_all();
+        this->infer_queue_->wake_all();
+        this->publish_queue_->wake_all();
+        for (auto &thread : this->pipeline_threads_)
+        {
+            thread.join();
+        }
+        this->pipeline_threads_.clear();
+    }
+
+    template <typename T>
+    void YoloXNode::enqueue(BoundedQueue<T> &queue, T &item)
+    {
+        size_t dropped = 0;
+        if (this->drop_oldest_)
+        {
+            dropped = queue.push_latest(item);
+        }
+        else if (!queue.try_push(item))
+        {
+            dropped = 1;
+        }
+        if (dropped > 0)
+        {
+            this->pipeline_dropped_ += dropped;
+            RCLCPP_WARN_THROTTLE(this->get_logger(), *this->get_clock(), 5000,
+                                 "pipeline is behind, %zu frames dropped so far", this->pipeline_dropped_.load());
+        }
+    }
+
+    void YoloXNode::convertLoop()
+    {
+        using namespace std::chrono_literals; // NOLINT
+        ReceivedImage msg;
+        while (this->pipeline_running_)
+        {
+            if (!this->image_queue_->pop_wait(msg, 100ms))
+            {
+                continue;
+            }
+            try
+            {
+                FramePtr frame = this->convertImage(msg);
+                if (frame)
+                {
+                    this->enqueue(*this->infer_queue_, frame);
+                }
+            }
+            catch (const std::exception &e)
+            {
+                RCLCPP_ERROR(this->get_logger(), "%s", e.what());
+            }
+            msg.first.reset();
+        }
+    }
+
+    void YoloXNode::inferLoop()
+    {
+        using namespace std::chrono_literals; // NOLINT
+        const size_t max_batch = this->params_.pipeline_max_batch;
+        std::vector<FramePtr> frames;
+        FramePtr frame;
+        while (this->pipeline_running_)
+        {
+            if (!this->infer_queue_->pop_wait(frame, 100ms))
+            {
+                continue;
+            }
+            // batch whatever else is already waiting
+            frames.clear();
+            frames.emplace_back(std::move(frame));
+            while (frames.size() < max_batch && this->infer_queue_->try_pop(frame))
+            {
+                frames.emplace_back(std::move(frame));
+            }
+            try
+            {
+                this->inferFrames(frames);
+            }
+            catch (const std::exception &e)
+            {
+                RCLCPP_ERROR(this->get_logger(), "%s", e.what());
+                continue;
+            }
+            for (auto &f : frames)
+            {
+                this->enqueue(*this->publish_queue_, f);
+            }
+        }
+    }
+
+    void YoloXNode::publishLoop()
+    {
+        using namespace std::chrono_literals; // NOLINT
+        FramePtr frame;
+        while (this->pipeline_running_)
+        {
+            if (!this->publish_queue_->pop_wait(frame, 100ms))
+            {
+                continue;
+            }
+            this->publishFrame(frame);
+            frame.reset();
         }
     }
 
-    bboxes_ex_msgs::msg::BoundingBoxes YoloXNode::objects_to_bboxes(
-        const cv::Mat &frame, const std::vector<yolox_cpp::Object> &objects, const std_msgs::msg::Header &header)
+    void YoloXNode::objects_to_bboxes(
+        const cv::Mat &frame, const std::vector<yolox_cpp::Object> &objects, const std_msgs::msg::Header &header,
+        bboxes_ex_msgs::msg::BoundingBoxes &boxes)
     {
-        bboxes_ex_msgs::msg::BoundingBoxes boxes;
         boxes.header = header;
-        for (const auto &obj : objects)
+        boxes.bounding_boxes.resize(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
         {
-            bboxes_ex_msgs::msg::BoundingBox box;
-            box.probability = obj.prob;;
+            const auto &obj = objects[i];
+            auto &box = boxes.bounding_boxes[i];
+            box.probability = obj.prob;
             box.class_id = std::to_string(obj.label);
             box.xmin = obj.rect.x;
             box.ymin = obj.rect.y;
@@ -178,18 +713,19 @@ namespace yolox_ros_cpp
             box.ymax = (obj.rect.y + obj.rect.height);
             box.img_width = frame.cols;
             box.img_height = frame.rows;
-            boxes.bounding_boxes.emplace_back(box);
         }
-        return boxes;
     }
 
-    vision_msgs::msg::Detection2DArray YoloXNode::objects_to_detection2d(const std::vector<yolox_cpp::Object> &objects, const std_msgs::msg::Header &header)
+    void YoloXNode::objects_to_detection2d(
+        const std::vector<yolox_cpp::Object> &objects, const std_msgs::msg::Header &header,
+        vision_msgs::msg::Detection2DArray &detection2d)
     {
-        vision_msgs::msg::Detection2DArray detection2d;
         detection2d.header = header;
-        for (const auto &obj : objects)
+        detection2d.detections.resize(objects.size());
+        for (size_t i = 0; i < objects.size(); ++i)
         {
-            vision_msgs::msg::Detection2D det;
+            const auto &obj = objects[i];
+            auto &det = detection2d.detections[i];
             det.bbox.center.position.x = obj.rect.x + obj.rect.width / 2;
             det.bbox.center.position.y = obj.rect.y + obj.rect.height / 2;
             det.bbox.size_x = obj.rect.width;
@@ -198,9 +734,7 @@ namespace yolox_ros_cpp
             det.results.resize(1);
             det.results[0].hypothesis.class_id = std::to_string(obj.label);
             det.results[0].hypothesis.score = obj.prob;
-            detection2d.detections.emplace_back(det);
         }
-        return detection2d;
     }
 }
 